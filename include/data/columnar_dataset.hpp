@@ -0,0 +1,111 @@
+#ifndef DATA_COLUMNAR_DATASET_HPP
+#define DATA_COLUMNAR_DATASET_HPP
+
+#include "../utils/binary_io.hpp"
+#include "dataset.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// states are stored in full at least once every this many states of a problem, which bounds the
+// number of deltas applied to decode a single state
+#define COLUMNAR_KEYFRAME_INTERVAL 64
+
+namespace wlplan {
+  namespace data {
+    // Read only array that either owns its values or views a memory mapped file kept alive by
+    // the owner pointer
+    template <typename T>
+    class Column {
+      std::shared_ptr<const void> owner;
+      const T *ptr = nullptr;
+      size_t n = 0;
+
+     public:
+      Column() = default;
+      Column(std::vector<T> values) {
+        auto vec = std::make_shared<const std::vector<T>>(std::move(values));
+        ptr = vec->data();
+        n = vec->size();
+        owner = vec;
+      }
+      Column(const std::shared_ptr<const void> &owner, const T *ptr, size_t n)
+          : owner(owner), ptr(ptr), n(n) {}
+
+      size_t size() const { return n; }
+      const T *data() const { return ptr; }
+      const T &operator[](size_t i) const { return ptr[i]; }
+    };
+
+    // Columns of the states and actions of one problem. Atoms and actions are interned into
+    // tables of predicate or schema ids with object ids. State i is the list of atom ids
+    // state_atoms[state_offsets[i]:state_offsets[i + 1]] if it is a keyframe, and otherwise the
+    // changes from state i - 1, where an atom id a is added and ~a is deleted.
+    struct ColumnarProblem {
+      planning::Problem problem;
+
+      Column<int> atom_predicates;
+      Column<int> atom_objects;
+      Column<int> atom_offsets;
+
+      Column<uint8_t> keyframes;
+      Column<int> state_atoms;
+      Column<int> state_offsets;
+      // values of state i are values[i * n_values:(i + 1) * n_values]
+      int n_values = 0;
+      Column<double> values;
+
+      Column<int> action_schemata;
+      Column<int> action_objects;
+      Column<int> action_offsets;
+      Column<int> state_actions;
+      Column<int> state_action_offsets;
+
+      ColumnarProblem(const planning::Problem &problem) : problem(problem) {}
+
+      size_t get_size() const { return keyframes.size(); }
+    };
+
+    // Columnar form of a DomainDataset, which can be saved to a binary file and loaded with
+    // mmap so that states are only decoded when they are accessed.
+    class ColumnarDataset {
+      planning::Domain domain;
+      std::vector<ColumnarProblem> problems;
+
+      ColumnarDataset(const planning::Domain &domain, std::vector<ColumnarProblem> &&problems);
+
+      // updates the sorted atom ids true in state i - 1 to those of state i
+      static void apply_state(const ColumnarProblem &data, size_t i, std::vector<int> &true_ids);
+      static planning::State
+      to_state(const ColumnarProblem &data, size_t i, const std::vector<int> &true_ids);
+
+     public:
+      explicit ColumnarDataset(const DomainDataset &dataset);
+
+      // the file is memory mapped, and columns stay valid while any copy of the dataset lives
+      static ColumnarDataset load(const std::string &path);
+      void save(const std::string &path) const;
+
+      // columns are viewed in place if the reader owns its input, and otherwise copied
+      static ColumnarDataset read(utils::BinaryReader &reader);
+      void write(utils::BinaryWriter &writer) const;
+
+      const planning::Domain &get_domain() const { return domain; }
+      size_t get_n_problems() const { return problems.size(); }
+      size_t get_size() const;
+
+      const planning::Problem &get_problem(size_t i) const { return problems.at(i).problem; }
+      // packed states of problem i, decoded in one pass over its deltas
+      std::vector<planning::State> get_states(size_t i) const;
+      planning::State get_state(size_t i, size_t j) const;
+      std::vector<planning::Actions> get_actions(size_t i) const;
+
+      ProblemDataset get_problem_dataset(size_t i) const;
+      DomainDataset to_domain_dataset() const;
+    };
+  }  // namespace data
+}  // namespace wlplan
+
+#endif  // DATA_COLUMNAR_DATASET_HPP
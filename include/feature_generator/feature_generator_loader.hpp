@@ -1,6 +1,7 @@
 #ifndef FEATURE_GENERATOR_FEATURE_GENERATOR_LOADER_HPP
 #define FEATURE_GENERATOR_FEATURE_GENERATOR_LOADER_HPP
 
+#include "../utils/binary_io.hpp"
 #include "features.hpp"
 
 #include <memory>
@@ -9,4 +10,8 @@
 std::shared_ptr<wlplan::feature_generator::Features>
 load_feature_generator(const std::string save_file);
 
+// reads the binary form of Features::write as the feature generator class it was written from
+std::unique_ptr<wlplan::feature_generator::Features>
+read_feature_generator(wlplan::utils::BinaryReader &reader);
+
 #endif  // FEATURE_GENERATOR_FEATURE_GENERATOR_LOADER_HPP
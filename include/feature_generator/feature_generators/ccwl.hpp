@@ -31,7 +31,9 @@ namespace wlplan {
 
       CCWLFeatures(const std::string &filename, bool quiet);
 
-      int get_n_features() const override;
+      CCWLFeatures(utils::BinaryReader &reader);
+
+      long get_n_features() const override;
 
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
     };
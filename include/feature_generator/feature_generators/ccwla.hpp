@@ -24,9 +24,24 @@ namespace wlplan {
 
       CCWLaFeatures(const std::string &filename, bool quiet);
 
-      int get_n_features() const override;
+      CCWLaFeatures(utils::BinaryReader &reader);
+
+      long get_n_features() const override;
 
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
+
+      // Restrict the max(x_i - x_j, 0) features to the given (i, j) colour pairs, appended in the
+      // given order after the categorical and continuous features. An empty list uses all pairs.
+      void set_selected_pairs(const std::vector<std::pair<int, int>> &pairs);
+      std::vector<std::pair<int, int>> get_selected_pairs() const { return selected_pairs; }
+
+      // feature index of the (i, j) colour pair when all pairs are used
+      long get_pair_feature_index(int i, int j) const;
+
+     protected:
+      SparseEmbedding
+      embed_sparse_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
+      double predict_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
     };
   }  // namespace feature_generator
 }  // namespace wlplan
@@ -31,6 +31,8 @@ namespace wlplan {
 
       IWLFeatures(const std::string &filename, bool quiet);
 
+      IWLFeatures(utils::BinaryReader &reader);
+
       std::unordered_map<int, int> collect_embed(const planning::State &state) override;
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
 
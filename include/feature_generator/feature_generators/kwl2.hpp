@@ -31,10 +31,19 @@ namespace wlplan {
 
       KWL2Features(const std::string &filename, bool quiet);
 
-      int get_n_features() const override;
+      KWL2Features(utils::BinaryReader &reader);
+
+      long get_n_features() const override;
 
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
 
+      // Bound the cost of each graph to roughly `budget` pair-witness evaluations by only
+      // colouring the pairs and witnesses of a seeded sample of nodes. Counts are scaled up by
+      // the inverse of the pair sampling rate. A budget of 0 disables sampling.
+      void set_sampling(long budget, int seed);
+      long get_sample_budget() const { return sample_budget; }
+      int get_sample_seed() const { return sample_seed; }
+
      protected:
       inline int get_initial_colour(int index,
                                     int u,
@@ -42,9 +51,13 @@ namespace wlplan {
                                     const std::shared_ptr<graph_generator::Graph> &graph,
                                     const std::vector<int> &pair_to_edge_label);
       void collect_impl(const std::vector<graph_generator::Graph> &graphs) override;
-      void refine(const std::shared_ptr<graph_generator::Graph> &graph,
-                  std::vector<int> &colours,
-                  int iteration);
+      // refines the colours of all pairs of the n_nodes (sampled) nodes
+      void refine(int n_nodes, std::vector<int> &colours, int iteration);
+      // deterministic node sample for a graph, or all nodes if it is within the budget
+      std::vector<int> get_sampled_nodes(int n_nodes) const;
+      // initial pair colours of the sampled nodes
+      std::vector<int> get_initial_colours(const std::shared_ptr<graph_generator::Graph> &graph,
+                                           const std::vector<int> &nodes);
     };
   }  // namespace feature_generator
 }  // namespace wlplan
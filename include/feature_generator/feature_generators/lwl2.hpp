@@ -24,6 +24,8 @@ namespace wlplan {
 
       LWL2Features(const std::string &filename, bool quiet);
 
+      LWL2Features(utils::BinaryReader &reader);
+
       std::unordered_map<int, int> collect_embed(const planning::State &state) override;
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
 
@@ -34,6 +36,9 @@ namespace wlplan {
                                     const std::shared_ptr<graph_generator::Graph> &graph,
                                     const std::vector<int> &pair_to_edge_label);
       void collect_impl(const std::vector<graph_generator::Graph> &graphs) override;
+      // runs all iterations on a graph and calls on_colour(iteration, colour) for every pair
+      template <typename OnColour>
+      void refine_graph(const std::shared_ptr<graph_generator::Graph> &graph, OnColour on_colour);
       void refine(const std::shared_ptr<graph_generator::Graph> &graph,
                   std::vector<std::set<int>> &pair_to_neighbours,
                   std::vector<int> &colours,
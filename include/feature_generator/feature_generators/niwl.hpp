@@ -21,6 +21,8 @@ namespace wlplan {
 
       NIWLFeatures(const std::string &filename, bool quiet);
 
+      NIWLFeatures(utils::BinaryReader &reader);
+
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
     };
   }  // namespace feature_generator
@@ -2,11 +2,15 @@
 #define FEATURE_GENERATOR_FEATURE_GENERATORS_WL_HPP
 
 #include "../features.hpp"
+#include "../refinement_options.hpp"
 
 #include <memory>
 #include <string>
 #include <vector>
 
+// edge label for a node's own colour in its signature, distinct from graph edge labels
+#define SIGNATURE_SELF_LABEL -1
+
 namespace wlplan {
   namespace feature_generator {
     class WLFeatures : public Features {
@@ -28,17 +32,69 @@ namespace wlplan {
 
       WLFeatures(const std::string &filename, bool quiet);
 
-      int get_n_features() const override;
+      WLFeatures(utils::BinaryReader &reader);
+
+      long get_n_features() const override;
 
       std::unordered_map<int, int> collect_embed(const planning::State &state) override;
       Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) override;
 
+      // choose the colour refinement engine, see RefinementOptions
+      void set_refinement(const std::string &refinement);
+      std::string get_refinement() const { return refinement; }
+
+      void write(utils::BinaryWriter &writer) const override;
+
+      // Replace the sorted neighbour key of a node with a 64-bit signature, which is the sum of
+      // mixed hashes of its own colour and its (colour, edge label) neighbour pairs. This avoids
+      // sorting and variable length keys at the cost of possible hash collisions, which are
+      // reported in debug builds. Requires multiset hashing and no pruning, and must be set
+      // before collect().
+      void set_signature_hash(bool signature_hash);
+      bool get_signature_hash() const { return signature_hash; }
+
      protected:
+      // reused memory for the {hi, lo} key of a signature
+      std::vector<int> signature_key;
+      // signature to sorted key per layer for collision detection in debug builds
+      std::vector<std::unordered_map<std::vector<int>, std::vector<int>, int_vector_hasher>>
+          signature_to_key;
+
       void collect_impl(const std::vector<graph_generator::Graph> &graphs) override;
+      // colour of node u in the next iteration, or UNSEEN_COLOUR
+      template <typename ColourOf>
+      inline int get_refined_colour(const std::shared_ptr<graph_generator::Graph> &graph,
+                                    int u,
+                                    ColourOf colour_of,
+                                    int iteration);
+      // fills signature_key for node u, and returns false if a colour is unseen
+      template <typename ColourOf>
+      inline bool set_signature_key(const std::shared_ptr<graph_generator::Graph> &graph,
+                                    int u,
+                                    ColourOf colour_of);
+      // checks that the signature in signature_key is not shared with a different sorted key
+      void check_signature_collision(const std::vector<int> &sorted_key, int iteration);
       void refine(const std::shared_ptr<graph_generator::Graph> &graph,
                   std::set<int> &nodes,
                   std::vector<int> &colours,
                   int iteration);
+      // Once an iteration does not split any colour class, the partition is stable and each
+      // class maps to a single colour in every further iteration. This refines by computing the
+      // key of one representative node per class and mapping the remaining nodes.
+      void refine_stable(const std::shared_ptr<graph_generator::Graph> &graph,
+                         std::vector<int> &colours,
+                         int iteration);
+      // Node refinement engine running all iterations on a graph, fast-forwarding once the
+      // partition is stable. Calls on_colour(iteration, colour) for every node and iteration.
+      template <typename OnColour>
+      void refine_graph(const std::shared_ptr<graph_generator::Graph> &graph, OnColour on_colour);
+      // Partition refinement engine running all iterations on a graph. Colours are stored per
+      // colour class, and only nodes in or with an edge to a class split off in the previous
+      // iteration have their keys recomputed. Other classes map to the colour of a
+      // representative node. Calls on_class(iteration, colour, class_size) for every class.
+      template <typename OnClass>
+      void refine_partition(const std::shared_ptr<graph_generator::Graph> &graph,
+                            OnClass on_class);
       // for when we know that there are no unseen colours
       void refine_fast(const std::shared_ptr<graph_generator::Graph> &graph,
                        std::vector<int> &colours,
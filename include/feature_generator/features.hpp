@@ -6,8 +6,12 @@
 #include "../graph_generator/graph_generator.hpp"
 #include "../planning/domain.hpp"
 #include "../planning/state.hpp"
+#include "../utils/binary_io.hpp"
+#include "../utils/count_min_sketch.hpp"
+#include "../utils/hashing.hpp"
 #include "neighbour_container.hpp"
 #include "pruning_options.hpp"
+#include "refinement_options.hpp"
 
 #include <map>
 #include <memory>
@@ -19,6 +23,8 @@
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 #define UNSEEN_COLOUR -1
+#define COLLECT_CHUNK_SIZE 1024  // graphs held in memory at once by streaming collection
+#define DEFAULT_FREQUENCY_THRESHOLD 0.01
 
 #define debug_hash(k, v)                                                                           \
   for (const int i : k) {                                                                          \
@@ -46,6 +52,7 @@ class int_vector_hasher {
 namespace wlplan {
   namespace feature_generator {
     using Embedding = std::vector<double>;
+    using SparseEmbedding = std::vector<std::pair<long, double>>;  // (feature index, value)
     using ColourHash = std::unordered_map<std::vector<int>, int, int_vector_hasher>;
     using VecColourHash = std::vector<ColourHash>;
     using StrColourHash = std::vector<std::unordered_map<std::string, int>>;
@@ -59,6 +66,14 @@ namespace wlplan {
       int iterations;  // equivalently, layers
       std::string pruning;
       bool multiset_hash;
+      long sample_budget;  // 2-kwl only, 0 for no sampling
+      int sample_seed;
+      std::vector<std::pair<int, int>> selected_pairs;  // ccwl-a only, empty for all pairs
+      bool signature_hash;     // wl-based only, keys are 64-bit neighbourhood signatures
+      std::string refinement;  // wl-based only, see RefinementOptions
+      long hash_dim;           // 0 for a colour dictionary, otherwise the number of hashed buckets
+      double frequency_threshold;   // frequency pruning only, as a fraction of the number of graphs
+      long frequency_sketch_width;  // frequency pruning only, 0 for exact counts
 
       // colouring [saved]
       VecColourHash colour_hash;
@@ -68,6 +83,8 @@ namespace wlplan {
       // optional linear weights [saved]
       bool store_weights;
       std::vector<double> weights;
+      // alternative to dense weights for large feature spaces, used if weights is empty
+      std::unordered_map<long, double> sparse_weights;
 
       // helper variables
       std::shared_ptr<planning::Domain> domain;
@@ -76,6 +93,12 @@ namespace wlplan {
       bool collected;
       bool collecting;
       bool pruned;
+      bool greedy_maxsat;  // allow MaxSAT pruning to fall back to the greedy solver
+      // per graph counts of the colours of all layers refined so far during layer pruning
+      std::vector<std::unordered_map<int, int>> layer_colour_counts;
+      // counts of the colours of the current layer over all graphs during frequency pruning
+      std::vector<long> colour_frequencies;
+      utils::CountMinSketch colour_frequency_sketch;
 
       // logger variables
       bool quiet;
@@ -89,6 +112,19 @@ namespace wlplan {
       int get_colour_hash(const std::vector<int> &colour, const int iteration);
       // fast ver. that assumes no unseen colours (e.g. collecting), and does not store itr info
       int get_colour_hash_fast(const std::vector<int> &colour, const int iteration);
+      // dictionary-free colour of a key in a layer for when hash_dim > 0, which is never unseen
+      int get_hashed_colour(const std::vector<int> &colour, const int iteration) const;
+
+      // add value to the feature of a seen colour at an offset, which is a signed hash bucket
+      // when hash_dim > 0
+      inline void add_to_feature(int colour, double value, Embedding &x, int offset = 0) const {
+        if (hash_dim > 0) {
+          uint64_t h = utils::mix64(colour);
+          x[offset + h % hash_dim] += (h >> 63) ? -value : value;
+        } else {
+          x[offset + colour] += value;
+        }
+      }
 
       // reformat colour hash based on colours to throw out
       VecColourHash new_colour_hash() const;
@@ -101,9 +137,23 @@ namespace wlplan {
       // common init for initialisation and loading from file
       void initialise_variables();
 
+      // collect a chunk of graphs without pruning
+      void collect_graphs_chunk(const std::vector<graph_generator::Graph> &graphs);
+
       // main virtual functions
       virtual void collect_impl(const std::vector<graph_generator::Graph> &graphs) = 0;
       virtual Embedding embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) = 0;
+      virtual SparseEmbedding
+      embed_sparse_impl(const std::shared_ptr<graph_generator::Graph> &graph);
+      virtual double predict_impl(const std::shared_ptr<graph_generator::Graph> &graph);
+
+      // weight of a feature from either the dense or sparse weights
+      inline double get_weight(long index) const {
+        if (!weights.empty())
+          return weights[index];
+        auto it = sparse_weights.find(index);
+        return it == sparse_weights.end() ? 0 : it->second;
+      }
 
      public:
       Features(const std::string feature_name,
@@ -117,48 +167,84 @@ namespace wlplan {
 
       Features(const std::string &filename, const bool quiet);
 
+      // Reads the binary form written by write(), which holds what save() does in less space
+      // together with the collection state. Used for pickling.
+      Features(utils::BinaryReader &reader);
+
       virtual ~Features() = default;
 
       /* Feature generation functions */
 
       // convert states to graphs
-      std::vector<graph_generator::Graph> to_graphs(const data::DomainDataset dataset);
+      std::vector<graph_generator::Graph> to_graphs(const data::DomainDataset &dataset);
 
-      // collect training colours
-      void collect_from_dataset(const data::DomainDataset dataset);
+      // collect training colours; without pruning, datasets are streamed in chunks of graphs
+      void collect_from_dataset(const data::DomainDataset &dataset);
       void collect(const std::vector<graph_generator::Graph> &graphs);
+      // add the colours of the states of one problem, for collecting over a stream of problems
+      // without holding the whole dataset in memory; does not support pruning
+      void collect_problem(const planning::Problem &problem,
+                           const std::vector<planning::State> &states);
+      // finish a collection, called once after the last collect_problem()
+      void end_collect();
+      // Refine only new graphs against the collected colours, appending unseen keys as new
+      // colours so that existing colours keep their ids. Returns the ids of the new colours.
+      std::vector<int> extend_from_dataset(const data::DomainDataset &dataset);
+      std::vector<int> extend(const std::vector<graph_generator::Graph> &graphs);
+      // Union the colours of a generator with the same configuration that was collected on other
+      // data. Colours are renumbered canonically from the union of keys, layer by layer, so that
+      // the result does not depend on the order of merging. Returns the maps from old colour ids
+      // of this and of the other generator to the merged ids. Stored weights are cleared.
+      std::pair<std::map<int, int>, std::map<int, int>> merge(const Features &other);
       // for novelty heuristics
       std::unordered_map<int, int> virtual collect_embed(const planning::State &state);
       void layer_redundancy_check();
 
       // embedding assumes training is done, and returns a feature matrix X
       std::vector<Embedding> embed_dataset(const data::DomainDataset &dataset);
+      std::vector<Embedding> embed_problem(const planning::Problem &problem,
+                                           const std::vector<planning::State> &states);
       std::vector<Embedding> embed_graphs(const std::vector<graph_generator::Graph> &graphs);
       Embedding embed_graph(const graph_generator::Graph &graph);
       Embedding embed_state(const planning::State &state);
       Embedding embed(const std::shared_ptr<graph_generator::Graph> &graph);
 
+      // sparse embeddings only contain non-zero features
+      std::vector<SparseEmbedding> embed_sparse_dataset(const data::DomainDataset &dataset);
+      std::vector<SparseEmbedding>
+      embed_sparse_graphs(const std::vector<graph_generator::Graph> &graphs);
+      SparseEmbedding embed_sparse_state(const planning::State &state);
+
       void add_colour_to_x(int colour, int iteration, Embedding &x);
+      void add_colour_to_x(int colour, int iteration, Embedding &x, double weight);
 
       /* Pruning functions */
 
-      // output maps equivalent features to the same group
+      // output maps equivalent features to the same group, numbered in order of first occurrence
       std::map<int, int> get_equivalence_groups(const std::vector<Embedding> &X);
-      void prune_this_iteration(int iteration,
-                                const std::vector<graph_generator::Graph> &graphs,
-                                std::vector<std::vector<int>> &cur_colours);
+      // sparse ver. that hashes columns in one pass over the samples and only compares columns
+      // with equal hashes, so that no dense copy of X is needed
+      std::map<int, int> get_equivalence_groups(const std::vector<SparseEmbedding> &X,
+                                                int n_features);
+      // Layer pruning keeps running per graph colour counts instead of re-embedding all graphs
+      // every iteration. init_layer_pruning counts the initial colours, and each call of
+      // prune_this_iteration adds the colours of the current layer before pruning.
+      void init_layer_pruning(const std::vector<std::vector<int>> &cur_colours);
+      void prune_this_iteration(int iteration, std::vector<std::vector<int>> &cur_colours);
+      void add_layer_colour_counts(const std::vector<std::vector<int>> &cur_colours);
+      void add_colour_frequencies(const std::vector<std::vector<int>> &cur_colours);
+      long get_colour_frequency(int colour) const;
       void prune_bulk(const std::vector<graph_generator::Graph> &graphs);
+      // sparse feature matrix of the layers refined so far from the running colour counts
+      std::vector<SparseEmbedding> get_layer_pruning_X() const;
 
       std::set<int> prune_collapse_layer(int iteration, std::vector<std::vector<int>> &cur_colours);
       std::set<int> prune_collapse_layer_greedy(int iteration,
-                                                const std::vector<graph_generator::Graph> &graphs);
+                                                const std::vector<SparseEmbedding> &X);
       std::set<int> prune_collapse_layer_maxsat(int iteration,
-                                                const std::vector<graph_generator::Graph> &graphs);
-      std::set<int>
-      prune_collapse_layer_frequency(int iteration,
-                                     const std::vector<graph_generator::Graph> &graphs);
-      std::set<int> prune_maxsat(std::vector<Embedding> X);
-      std::set<int> prune_maxsat(std::vector<Embedding> X, const int maxsat_iterations);
+                                                const std::vector<SparseEmbedding> &X);
+      std::set<int> prune_collapse_layer_frequency(int iteration, size_t n_graphs);
+      std::set<int> prune_maxsat(const std::vector<SparseEmbedding> &X, const int maxsat_iterations);
 
       /* Prediction functions */
 
@@ -167,7 +253,9 @@ namespace wlplan {
       double predict(const planning::State &state);
 
       void set_weights(const std::vector<double> &weights);
+      void set_sparse_weights(const SparseEmbedding &weights);
       std::vector<double> get_weights() const;
+      SparseEmbedding get_sparse_weights() const;
 
       /* Getter functions */
 
@@ -177,6 +265,22 @@ namespace wlplan {
       int get_iterations() const { return iterations; }
       std::string get_pruning() { return pruning; }
       void set_pruning(const std::string &pruning) { this->pruning = pruning; }
+      // Hash each (layer, key) directly into one of hash_dim buckets with a signed hash instead
+      // of building a colour dictionary, so that the number of colours is fixed to hash_dim and
+      // collect() is optional. A hash_dim of 0 restores the dictionary.
+      void set_hash_dim(long hash_dim);
+      long get_hash_dim() const { return hash_dim; }
+      // Frequency pruning removes colours that occur at most threshold * (number of graphs) times
+      // over all graphs. Counts are gathered per layer during collection, exactly if sketch_width
+      // is 0, or otherwise in a count-min sketch of COUNT_MIN_SKETCH_DEPTH rows of sketch_width
+      // counters that overestimates counts, so it never prunes more than exact counting.
+      void set_frequency_pruning(double threshold, long sketch_width);
+      double get_frequency_threshold() const { return frequency_threshold; }
+      long get_frequency_sketch_width() const { return frequency_sketch_width; }
+      // MaxSAT pruning raises if pysat is unavailable unless the approximate greedy solver is
+      // allowed. Builds without Python always use the greedy solver.
+      void set_greedy_maxsat(bool greedy_maxsat) { this->greedy_maxsat = greedy_maxsat; }
+      bool get_greedy_maxsat() const { return greedy_maxsat; }
       std::set<int> get_iteration_colours(int iteration) const {
         return layer_to_colours.at(iteration);
       }
@@ -200,7 +304,7 @@ namespace wlplan {
 
       // statistics functions
       int get_n_colours() const;
-      virtual int get_n_features() const = 0;
+      virtual long get_n_features() const = 0;
       std::vector<long> get_seen_counts() const { return seen_colour_statistics[1]; };
       std::vector<long> get_unseen_counts() const { return seen_colour_statistics[0]; };
       std::vector<long> get_layer_to_n_colours() const;
@@ -211,6 +315,7 @@ namespace wlplan {
 
       void save(const std::string &filename);
       void save(const std::string &filename, const std::vector<double> &weights);
+      virtual void write(utils::BinaryWriter &writer) const;
     };
   }  // namespace feature_generator
 }  // namespace wlplan
@@ -28,7 +28,12 @@ namespace wlplan {
       std::set<int> variables;
       std::vector<MaxSatClause> clauses;
 
-      std::map<int, int> call_solver();
+      // clauses as signed literals, split into hard and weighted soft clauses
+      void to_literals(std::vector<std::vector<int>> &hard,
+                       std::vector<std::vector<int>> &soft,
+                       std::vector<int> &weights) const;
+
+      std::map<int, int> call_solver(bool allow_greedy);
 
      public:
       MaxSatProblem(const std::vector<MaxSatClause> &clauses);
@@ -36,7 +41,16 @@ namespace wlplan {
       int get_n_variables() const { return variables.size(); }
       int get_n_clauses() const { return clauses.size(); }
 
-      std::map<int, int> solve();
+      // Solves with RC2 from pysat, or with solve_greedy() for the C++ interface. If pysat is not
+      // available, falls back to solve_greedy() only if allow_greedy and throws otherwise.
+      std::map<int, int> solve(bool allow_greedy = false);
+
+      // Native approximate solver for the feature pruning encoding: positive unit soft clauses,
+      // hard implications (a | ~b), and hard clauses of only negative literals. Starting from
+      // all variables true, the negative clauses with the fewest literals are satisfied first by
+      // setting to false the literal whose implication closure flips the fewest variables.
+      // Throws NotSupportedError for other clauses.
+      std::map<int, int> solve_greedy();
 
       std::string to_string();
     };
@@ -5,7 +5,9 @@
 
 #include <map>
 #include <set>
+#include <tuple>
 #include <utility>
+#include <vector>
 
 namespace wlplan {
   namespace feature_generator {
@@ -22,6 +24,10 @@ namespace wlplan {
       std::vector<int> get_neighbour_colours(const std::vector<int> &colours) override;
       std::vector<int> remap(const std::vector<int> &input,
                              const std::map<int, int> &remap) override;
+
+     protected:
+      // keys start with the pair's own colour instead of ending with it as in WL keys
+      std::vector<std::tuple<int, int, int>> deconstruct_pairs(const std::vector<int> &colours);
     };
   }  // namespace feature_generator
 }  // namespace wlplan
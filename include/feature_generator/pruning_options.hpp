@@ -8,6 +8,8 @@ namespace wlplan {
   namespace feature_generator {
     class PruningOptions {
      public:
+      // MaxSAT options are solved exactly with pysat, or approximately with a greedy solver
+      // in builds without Python, see MaxSatProblem::solve
       static const std::string NONE;
       static const std::string ALL_MAXSAT;
       static const std::string LAYER_GREEDY;            // bfg2019
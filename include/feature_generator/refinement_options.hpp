@@ -0,0 +1,19 @@
+#ifndef FEATURE_GENERATOR_FEATURE_REFINEMENT_OPTIONS_HPP
+#define FEATURE_GENERATOR_FEATURE_REFINEMENT_OPTIONS_HPP
+
+#include <string>
+#include <vector>
+
+namespace wlplan {
+  namespace feature_generator {
+    class RefinementOptions {
+     public:
+      static const std::string NODE;       // recompute the key of every node every iteration
+      static const std::string PARTITION;  // only recompute keys of nodes next to split classes
+
+      static const std::vector<std::string> get_all();
+    };
+  }  // namespace feature_generator
+}  // namespace wlplan
+
+#endif  // FEATURE_GENERATOR_FEATURE_REFINEMENT_OPTIONS_HPP
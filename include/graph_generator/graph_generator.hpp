@@ -20,7 +20,7 @@ namespace wlplan::graph_generator {
 
   class GraphGenerator {
    public:
-    GraphGenerator(const planning::Domain &domain,
+    GraphGenerator(const std::shared_ptr<const planning::Domain> &domain,
                    const bool differentiate_constant_objects,
                    const std::string &graph_generator_name);
 
@@ -30,12 +30,12 @@ namespace wlplan::graph_generator {
     virtual void set_problem(const planning::Problem &problem) = 0;
 
     // Makes a copy of the base graph and makes the necessary modifications. Assumes the state is
-    // from the problem that is set but does not check this.
+    // from the problem that is set; this is only checked for the symbols of packed states.
     virtual std::shared_ptr<Graph> to_graph(const planning::State &state) = 0;
     virtual std::shared_ptr<Graph> to_graph(const planning::State &state,
                                             const planning::ActionPointers &actions) = 0;
     std::shared_ptr<Graph> to_graph(const planning::State &state, const planning::Actions &actions);
-    std::vector<graph_generator::Graph> to_graphs(const data::DomainDataset dataset);
+    std::vector<graph_generator::Graph> to_graphs(const data::DomainDataset &dataset);
 
     // Optimised variant of to_graph() but requires calling reset_graph() after. Does not make a
     // copy of the base graph and instead modifies it directly, and undoing the modifications with
@@ -51,7 +51,7 @@ namespace wlplan::graph_generator {
     void print_init_colours() const;
 
    protected:
-    const planning::Domain domain;
+    const std::shared_ptr<const planning::Domain> domain;
     bool differentiate_constant_objects;
     const std::string graph_generator_name;
 
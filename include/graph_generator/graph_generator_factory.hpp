@@ -8,12 +8,14 @@
 #include <string>
 
 namespace wlplan::graph_generator {
-  std::shared_ptr<GraphGenerator> init_feature_generator(const std::string &name,
-                                                         const planning::Domain &domain);
+  std::shared_ptr<GraphGenerator>
+  init_feature_generator(const std::string &name,
+                         const std::shared_ptr<const planning::Domain> &domain);
 
-  std::shared_ptr<GraphGenerator> init_feature_generator(const std::string &name,
-                                                         const planning::Domain &domain,
-                                                         bool differentiate_constant_objects);
+  std::shared_ptr<GraphGenerator>
+  init_feature_generator(const std::string &name,
+                         const std::shared_ptr<const planning::Domain> &domain,
+                         bool differentiate_constant_objects);
 }  // namespace wlplan::graph_generator
 
 #endif  // GRAPH_GENERATOR_GRAPH_GENERATOR_FACTORY_HPP
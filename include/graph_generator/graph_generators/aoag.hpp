@@ -21,7 +21,8 @@
 namespace wlplan::graph_generator {
   class AOAGGenerator : public ILGGenerator {
    public:
-    AOAGGenerator(const planning::Domain &domain, const bool differentiate_constant_objects);
+    AOAGGenerator(const std::shared_ptr<const planning::Domain> &domain,
+                  const bool differentiate_constant_objects);
 
     // Graph generation
     std::shared_ptr<Graph> to_graph(const planning::State &state) override;
@@ -33,7 +34,7 @@ namespace wlplan::graph_generator {
     // Graph features
     int get_n_features() const override { return colour_to_description.size(); };
     int get_n_relations() const override {
-      return std::max(domain.get_predicate_arity(), domain.get_schemata_arity());
+      return std::max(domain->get_predicate_arity(), domain->get_schemata_arity());
     };
 
    private:
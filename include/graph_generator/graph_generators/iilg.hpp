@@ -13,7 +13,7 @@
 namespace wlplan::graph_generator {
   class IILGGenerator : public ILGGenerator {
    public:
-    IILGGenerator(const planning::Domain &domain);
+    IILGGenerator(const std::shared_ptr<const planning::Domain> &domain);
 
     // Graph generation
     void set_problem(const planning::Problem &problem) override;
@@ -12,6 +12,7 @@
 #include "../../planning/domain.hpp"
 #include "../../planning/problem.hpp"
 #include "../../planning/state.hpp"
+#include "../../utils/hashing.hpp"
 #include "../graph.hpp"
 #include "../graph_generator.hpp"
 
@@ -37,8 +38,9 @@ enum class ILGFactDescription { ILG_FACT_DESCRIPTIONS };
 namespace wlplan::graph_generator {
   class ILGGenerator : public GraphGenerator {
    public:
-    ILGGenerator(const planning::Domain &domain, const bool differentiate_constant_objects);
-    ILGGenerator(const planning::Domain &domain,
+    ILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
+                 const bool differentiate_constant_objects);
+    ILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
                  const bool differentiate_constant_objects,
                  const std::string &derived_graph_generator_name);
 
@@ -52,12 +54,20 @@ namespace wlplan::graph_generator {
 
     // Graph features
     int get_n_features() const override { return colour_to_description.size(); };
-    int get_n_relations() const override { return domain.get_predicate_arity(); };
+    int get_n_relations() const override { return domain->get_predicate_arity(); };
 
    protected:
     int fact_colour(const int predicate_idx, const ILGFactDescription &fact_description) const;
     int fact_colour(const planning::Atom &atom, const ILGFactDescription &fact_description) const;
 
+    /* Nodes by ids of the problem symbol table, for packed states */
+    // last symbol table checked to equal the one of the problem
+    std::shared_ptr<const planning::SymbolTable> packed_symbol_table;
+    std::vector<int> object_id_to_node;
+    // keys are a predicate id followed by object ids
+    std::unordered_map<std::vector<int>, int, utils::IntVectorHash> packed_positive_goal_to_node;
+    std::unordered_map<std::vector<int>, int, utils::IntVectorHash> packed_negative_goal_to_node;
+
     /* For modifying the base graph and redoing its changes */
     int n_nodes_added;
     std::vector<int> n_edges_added;
@@ -78,7 +88,7 @@ namespace wlplan::graph_generator {
 
   inline int ILGGenerator::fact_colour(const planning::Atom &atom,
                                        const ILGFactDescription &fact_description) const {
-    return fact_colour(domain.predicate_to_colour.at(atom.predicate->name), fact_description);
+    return fact_colour(domain->predicate_to_colour.at(atom.predicate->name), fact_description);
   }
 }  // namespace wlplan::graph_generator
 
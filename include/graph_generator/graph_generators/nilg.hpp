@@ -19,7 +19,8 @@
 namespace wlplan::graph_generator {
   class NILGGenerator : public ILGGenerator {
    public:
-    NILGGenerator(const planning::Domain &domain, const bool differentiate_constant_objects);
+    NILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
+                  const bool differentiate_constant_objects);
 
     // Graph generation
     void set_problem(const planning::Problem &problem) override;
@@ -32,7 +33,7 @@ namespace wlplan::graph_generator {
       return colour_to_description.size() + 1;
     };
     int get_n_relations() const override {
-      return std::max(domain.get_predicate_arity(), domain.get_function_arity());
+      return std::max(domain->get_predicate_arity(), domain->get_function_arity());
     };
 
    protected:
@@ -44,9 +45,25 @@ namespace wlplan::graph_generator {
     int ACHIEVED_GTEQ_GOAL;
     int ACHIEVED_EQ_GOAL;
 
-    // Fluent values are given in every state.
+    // numeric goals of the current problem with compiled expressions
+    std::vector<planning::NumericCondition> numeric_goals;
+
+    /* Node indices of the current problem, so that numeric nodes are updated without names */
+    std::vector<int> fluent_nodes;
+    std::vector<int> numeric_goal_nodes;
+    // numeric goals that depend on each fluent
+    std::vector<std::vector<int>> fluent_to_numeric_goals;
+
+    /* Numeric state of the base graph, against which the values of states are diffed */
+    std::vector<double> base_fluent_values;
+    bool base_numeric_goals_evaluated;
+
+    // Fluent values are given in every state. Only fluents whose values differ from those of the
+    // base graph and the numeric goals depending on them are updated. If store_changes is true,
+    // graph is the base graph and its numeric state is updated.
     std::shared_ptr<Graph> modify_graph_from_numerics(const planning::State &state,
-                                                      const std::shared_ptr<Graph> graph);
+                                                      const std::shared_ptr<Graph> graph,
+                                                      bool store_changes);
   };
 }  // namespace wlplan::graph_generator
 
@@ -26,7 +26,8 @@
 namespace wlplan::graph_generator {
   class PLOIGGenerator : public GraphGenerator {
    public:
-    PLOIGGenerator(const planning::Domain &domain, const bool differentiate_constant_objects);
+    PLOIGGenerator(const std::shared_ptr<const planning::Domain> &domain,
+                   const bool differentiate_constant_objects);
 
     // Graph generation
     void set_problem(const planning::Problem &problem) override;
@@ -0,0 +1,39 @@
+#ifndef GRAPH_GENERATOR_GRAPH_STREAM_HPP
+#define GRAPH_GENERATOR_GRAPH_STREAM_HPP
+
+#include "../data/dataset.hpp"
+#include "graph.hpp"
+#include "graph_generator.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace wlplan::graph_generator {
+
+  // Produces the graphs of a dataset one at a time instead of materialising all of them, and
+  // sets the problem of the graph generator when moving on to the next problem. The graph
+  // generator and dataset must outlive the stream.
+  class GraphStream {
+   public:
+    GraphStream(GraphGenerator &graph_generator, const data::DomainDataset &dataset);
+
+    // next graph, or nullptr once all graphs have been produced
+    std::shared_ptr<Graph> next();
+
+    // up to max_graphs next graphs, which is empty once all graphs have been produced
+    std::vector<Graph> next_chunk(size_t max_graphs);
+
+    size_t get_n_produced() const { return n_produced; }
+
+   private:
+    GraphGenerator &graph_generator;
+    const data::DomainDataset &dataset;
+
+    size_t problem_i;
+    size_t state_i;
+    bool problem_set;
+    size_t n_produced;
+  };
+}  // namespace wlplan::graph_generator
+
+#endif  // GRAPH_GENERATOR_GRAPH_STREAM_HPP
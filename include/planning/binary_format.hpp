@@ -0,0 +1,46 @@
+#ifndef PLANNING_BINARY_FORMAT_HPP
+#define PLANNING_BINARY_FORMAT_HPP
+
+#include "../utils/binary_io.hpp"
+#include "domain.hpp"
+#include "numeric_condition.hpp"
+#include "problem.hpp"
+#include "state.hpp"
+#include "symbol_table.hpp"
+
+#include <memory>
+
+namespace wlplan {
+  namespace planning {
+    // Compact binary forms of planning objects, used for pickling and dataset files. Readers
+    // throw std::runtime_error on malformed input.
+
+    // predicates are written in colour order, so that the read domain has the same colours
+    void write_domain(utils::BinaryWriter &writer, const Domain &domain);
+    Domain read_domain(utils::BinaryReader &reader);
+
+    // the expression is stored as its postfix program and the names of its fluents
+    void write_numeric_condition(utils::BinaryWriter &writer, const NumericCondition &condition);
+    NumericCondition read_numeric_condition(utils::BinaryReader &reader);
+
+    // problems are written without their domain, which is given when reading and shared
+    void write_problem(utils::BinaryWriter &writer, const Problem &problem);
+    Problem read_problem(utils::BinaryReader &reader, const std::shared_ptr<const Domain> &domain);
+
+    void write_symbol_table(utils::BinaryWriter &writer, const SymbolTable &symbol_table);
+    std::shared_ptr<const SymbolTable> read_symbol_table(utils::BinaryReader &reader);
+
+    // the table of a packed state, or a table of the symbols of an unpacked state
+    std::shared_ptr<const SymbolTable> get_state_symbol_table(const State &state);
+
+    // states are written as ids into a symbol table, which is given when reading and shared by
+    // the read state if it was packed
+    void write_state(utils::BinaryWriter &writer,
+                     const State &state,
+                     const SymbolTable &symbol_table);
+    State read_state(utils::BinaryReader &reader,
+                     const std::shared_ptr<const SymbolTable> &symbol_table);
+  }  // namespace planning
+}  // namespace wlplan
+
+#endif  // PLANNING_BINARY_FORMAT_HPP
@@ -43,6 +43,8 @@ namespace wlplan {
              const std::vector<Function> &functions);
 
       std::unordered_map<std::string, Predicate> get_name_to_predicate() const;
+      // predicates indexed by colour, from which a domain with the same colours is constructed
+      std::vector<Predicate> get_predicates_by_colour() const;
       std::unordered_map<std::string, Function> get_name_to_function() const;
       std::unordered_map<std::string, Schema> get_name_to_schema() const;
 
@@ -3,10 +3,13 @@
 
 #include "numeric_expression.hpp"
 
-#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
+// stack size of compiled conditions up to which evaluation does not allocate
+#define NUMERIC_CONDITION_STACK_SIZE 32
+
 namespace wlplan {
   namespace planning {
     enum ComparatorType {
@@ -19,8 +22,14 @@ namespace wlplan {
      private:
       ComparatorType comparator_type;
       std::shared_ptr<NumericExpression> expression;
-      std::function<bool(double)> compare;
-      std::function<double(double)> error;
+
+      // postfix program of the expression, compiled on construction
+      std::vector<NumericInstruction> program;
+      int stack_size;
+
+      double evaluate_expression(const double *values) const;
+      bool compare(double value) const;
+      double error(double value) const;
 
      public:
       NumericCondition(ComparatorType comparator_type,
@@ -28,6 +37,8 @@ namespace wlplan {
 
       ComparatorType get_comparator_type() const { return comparator_type; }
 
+      const std::shared_ptr<NumericExpression> &get_expression() const { return expression; }
+
       std::vector<int> get_fluent_ids() const { return expression->get_fluent_ids(); }
 
       bool evaluate_formula(const std::vector<double> &values) const;
@@ -36,6 +47,16 @@ namespace wlplan {
 
       std::pair<bool, double> evaluate_formula_and_error(const std::vector<double> &values) const;
 
+      // Evaluates many states at once from fluent values as a structure of arrays, where
+      // values[f * n_states + s] is the value of fluent f in state s. Sets formulas[s] and
+      // errors[s] to the results of evaluate_formula_and_error for state s.
+      void evaluate_batch(const std::vector<double> &values,
+                          size_t n_states,
+                          std::vector<bool> &formulas,
+                          std::vector<double> &errors) const;
+
+      const std::vector<NumericInstruction> &get_program() const { return program; }
+
       std::string to_string() const;
 
       bool operator==(const NumericCondition &other) const;
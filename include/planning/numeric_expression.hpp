@@ -15,18 +15,45 @@ namespace wlplan {
       Divide,
     };
 
+    enum class NumericOpcode {
+      PushConstant,
+      PushFluent,
+      Add,
+      Subtract,
+      Multiply,
+      Divide,
+    };
+
+    // Instruction of a postfix program evaluating a numeric expression on a stack
+    struct NumericInstruction {
+      NumericOpcode opcode;
+      int fluent_id;
+      double constant;
+    };
+
     class NumericExpression {
      public:
       virtual ~NumericExpression() = default;
 
       virtual double evaluate(const std::vector<double> &values) const = 0;
+      // appends a postfix program that evaluates this expression with the same operations
+      virtual void compile(std::vector<NumericInstruction> &program) const = 0;
+      // appends one instruction per node without folding, and the names of pushed fluents
+      virtual void to_postfix(std::vector<NumericInstruction> &program,
+                              std::vector<std::string> &fluent_names) const = 0;
       virtual std::vector<int> get_fluent_ids() const = 0;
       virtual std::string to_string() const = 0;
+
+      // rebuilds an expression from the output of to_postfix
+      static std::shared_ptr<NumericExpression>
+      from_postfix(const std::vector<NumericInstruction> &program,
+                   const std::vector<std::string> &fluent_names);
     };
 
     class FormulaExpression : public NumericExpression {
      private:
       std::function<double(double, double)> op;
+      NumericOpcode opcode;
       std::string op_symbol;
       const std::shared_ptr<NumericExpression> expr_a;
       const std::shared_ptr<NumericExpression> expr_b;
@@ -36,6 +63,9 @@ namespace wlplan {
                         std::shared_ptr<NumericExpression> expr_a,
                         std::shared_ptr<NumericExpression> expr_b);
       double evaluate(const std::vector<double> &values) const override;
+      void compile(std::vector<NumericInstruction> &program) const override;
+      void to_postfix(std::vector<NumericInstruction> &program,
+                      std::vector<std::string> &fluent_names) const override;
       std::vector<int> get_fluent_ids() const override;
       std::string to_string() const override;
     };
@@ -47,6 +77,9 @@ namespace wlplan {
      public:
       ConstantExpression(double value);
       double evaluate(const std::vector<double> &values) const override;
+      void compile(std::vector<NumericInstruction> &program) const override;
+      void to_postfix(std::vector<NumericInstruction> &program,
+                      std::vector<std::string> &fluent_names) const override;
       std::vector<int> get_fluent_ids() const override;
       std::string to_string() const override;
     };
@@ -59,6 +92,9 @@ namespace wlplan {
      public:
       FluentExpression(int id, std::string fluent_name);
       double evaluate(const std::vector<double> &values) const override;
+      void compile(std::vector<NumericInstruction> &program) const override;
+      void to_postfix(std::vector<NumericInstruction> &program,
+                      std::vector<std::string> &fluent_names) const override;
       std::vector<int> get_fluent_ids() const override;
       std::string to_string() const override;
     };
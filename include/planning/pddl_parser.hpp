@@ -0,0 +1,36 @@
+#ifndef PLANNING_PDDL_PARSER_HPP
+#define PLANNING_PDDL_PARSER_HPP
+
+#include "domain.hpp"
+#include "problem.hpp"
+
+#include <string>
+#include <vector>
+
+namespace wlplan {
+  namespace planning {
+    // Parsers for the subset of PDDL supported by wlplan: predicates, functions, constants,
+    // action names and arities, objects, initial fluent values, and positive, negative and
+    // numeric goals. Types are ignored, and so are initial atoms as in the pddl based parsers.
+    // Errors are thrown as std::runtime_error.
+
+    // If keep_statics is false, only predicates occurring in top level action effects are kept.
+    // An empty domain_name uses the name in the domain file.
+    Domain parse_domain(const std::string &domain_path,
+                        const std::string &domain_name,
+                        bool keep_statics);
+
+    Problem parse_problem(const std::string &domain_path,
+                          const std::string &problem_path,
+                          bool keep_statics);
+
+    // Parses the domain once and problems with n_threads threads, or one per core if it is not
+    // positive. Problems are returned in the order of problem_paths.
+    std::vector<Problem> parse_problems(const std::string &domain_path,
+                                        const std::vector<std::string> &problem_paths,
+                                        bool keep_statics,
+                                        int n_threads);
+  }  // namespace planning
+}  // namespace wlplan
+
+#endif  // PLANNING_PDDL_PARSER_HPP
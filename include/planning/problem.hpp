@@ -5,6 +5,7 @@
 #include "domain.hpp"
 #include "fluent.hpp"
 #include "numeric_condition.hpp"
+#include "symbol_table.hpp"
 
 #include <memory>
 #include <set>
@@ -19,9 +20,9 @@ namespace wlplan {
 
     class Problem {
      private:
-      std::shared_ptr<Domain> domain;
+      std::shared_ptr<const Domain> domain;
 
-      std::unordered_map<Object, int> object_to_id;
+      std::shared_ptr<SymbolTable> symbol_table;
       std::unordered_set<Object> problem_objects_set;
       std::unordered_set<Object> constant_objects_set;
       std::vector<Object> problem_objects;
@@ -37,6 +38,16 @@ namespace wlplan {
       std::vector<NumericCondition> numeric_goals;
 
      public:
+      // shares the domain with other problems instead of copying it
+      Problem(const std::shared_ptr<const Domain> &domain,
+              const std::vector<Object> &objects,
+              const std::vector<Atom> &statics,
+              const std::vector<Fluent> &fluents,
+              const std::vector<double> &fluent_values,
+              const std::vector<Atom> &positive_goals,
+              const std::vector<Atom> &negative_goals,
+              const std::vector<NumericCondition> &numeric_goals);
+
       Problem(const Domain &domain,
               const std::vector<Object> &objects,
               const std::vector<Atom> &statics,
@@ -59,25 +70,35 @@ namespace wlplan {
               const std::vector<Atom> &positive_goals,
               const std::vector<Atom> &negative_goals);
 
-      Domain get_domain() const { return *domain; }
+      // accessors return references to avoid copies in per state code
+      const Domain &get_domain() const { return *domain; }
+      const std::shared_ptr<const Domain> &get_domain_ptr() const { return domain; }
 
-      std::vector<Object> get_problem_objects() const { return problem_objects; }
-      std::vector<Object> get_constant_objects() const { return constant_objects; }
+      const std::vector<Object> &get_problem_objects() const { return problem_objects; }
+      const std::vector<Object> &get_constant_objects() const { return constant_objects; }
+      // predicate and object ids for packed states, shared by copies of this problem
+      std::shared_ptr<const SymbolTable> get_symbol_table() const { return symbol_table; }
+      const std::unordered_map<std::string, int> &get_predicate_to_id() const {
+        return symbol_table->get_predicate_to_id();
+      }
+      const std::unordered_map<Object, int> &get_object_to_id() const {
+        return symbol_table->get_object_to_id();
+      }
 
-      std::vector<Atom> get_statics() const { return statics; }
-      std::vector<Fluent> get_fluents() const { return fluents; }
-      std::vector<double> get_fluent_values() const { return fluent_values; }
+      const std::vector<Atom> &get_statics() const { return statics; }
+      const std::vector<Fluent> &get_fluents() const { return fluents; }
+      const std::vector<double> &get_fluent_values() const { return fluent_values; }
 
-      std::unordered_map<std::string, int> get_fluent_name_to_id() const {
+      const std::unordered_map<std::string, int> &get_fluent_name_to_id() const {
         return fluent_name_to_id;
       }
       int get_fluent_id(const std::string &fluent_name) const {
         return fluent_name_to_id.at(fluent_name);
       }
 
-      std::vector<Atom> get_positive_goals() const { return positive_goals; }
-      std::vector<Atom> get_negative_goals() const { return negative_goals; }
-      std::vector<NumericCondition> get_numeric_goals() const { return numeric_goals; }
+      const std::vector<Atom> &get_positive_goals() const { return positive_goals; }
+      const std::vector<Atom> &get_negative_goals() const { return negative_goals; }
+      const std::vector<NumericCondition> &get_numeric_goals() const { return numeric_goals; }
 
       bool is_constant_object(const Object &object) const {
         return constant_objects_set.count(object);
@@ -2,28 +2,65 @@
 #define PLANNING_STATE_HPP
 
 #include "atom.hpp"
+#include "symbol_table.hpp"
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace wlplan {
   namespace planning {
     class State {
+      // sum of the Zobrist keys of all atoms, which are assumed to be distinct
+      uint64_t atoms_hash;
+
+      void init_atoms_hash();
+      std::vector<std::string> get_sorted_atom_strings() const;
+      std::vector<std::vector<int>> get_sorted_packed_atoms() const;
+
      public:
+      // atoms are either stored as objects, or packed relative to a symbol table if it is set
       std::vector<std::shared_ptr<Atom>> atoms;
+      PackedAtoms packed_atoms;
+      std::shared_ptr<const SymbolTable> symbol_table;
       std::vector<double> values;
 
       State(const std::vector<std::shared_ptr<Atom>> &atoms, const std::vector<double> &values);
       State(const std::vector<std::shared_ptr<Atom>> &atoms);
       State(const std::vector<Atom> &atoms, const std::vector<double> &values);
       State(const std::vector<Atom> &atoms);
+      State(const std::shared_ptr<const SymbolTable> &symbol_table,
+            const PackedAtoms &atoms,
+            const std::vector<double> &values);
+      State(const std::shared_ptr<const SymbolTable> &symbol_table, const PackedAtoms &atoms);
+
+      bool is_packed() const { return symbol_table != nullptr; }
+      size_t get_n_atoms() const { return is_packed() ? packed_atoms.size() : atoms.size(); }
 
       std::vector<Atom> get_atoms() const;
-      std::vector<double> get_values() const;
+      // atoms as pointers, which are constructed if the state is packed
+      std::vector<std::shared_ptr<Atom>> get_atom_pointers() const;
+      const std::vector<double> &get_values() const { return values; }
+
+      // successor states with updated atoms and incrementally updated hashes; atoms to add that
+      // are already true and atoms to delete that are not true are ignored
+      State successor(const std::vector<Atom> &add_atoms,
+                      const std::vector<Atom> &delete_atoms,
+                      const std::vector<double> &values) const;
+      State successor(const std::vector<Atom> &add_atoms,
+                      const std::vector<Atom> &delete_atoms) const;
+      State successor(const PackedAtoms &add_atoms,
+                      const PackedAtoms &delete_atoms,
+                      const std::vector<double> &values) const;
 
       std::string to_string() const;
 
+      // states are equal if they have the same set of atoms and the same values, regardless of
+      // the order or representation of atoms
       bool operator==(const State &other) const;
 
+      // order independent hash, cached for atoms
       std::size_t hash() const;
     };
   }  // namespace planning
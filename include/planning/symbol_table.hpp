@@ -0,0 +1,90 @@
+#ifndef PLANNING_SYMBOL_TABLE_HPP
+#define PLANNING_SYMBOL_TABLE_HPP
+
+#include "atom.hpp"
+#include "object.hpp"
+#include "predicate.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wlplan {
+  namespace planning {
+    // Atoms as contiguous predicate and object ids relative to a SymbolTable. Atom i has predicate
+    // predicates[i] and objects objects[offsets[i]], ..., objects[offsets[i + 1] - 1].
+    struct PackedAtoms {
+      std::vector<int> predicates;
+      std::vector<int> objects;
+      std::vector<int> offsets = {0};
+
+      PackedAtoms() = default;
+      // copies n_atoms atoms from contiguous arrays, where offsets has n_atoms + 1 entries into
+      // objects and may start at a non-zero index, e.g. for slices of many states
+      PackedAtoms(const int *predicates, const int *objects, const int *offsets, size_t n_atoms);
+
+      size_t size() const { return predicates.size(); }
+      int get_arity(size_t i) const { return offsets[i + 1] - offsets[i]; }
+      const int *get_objects(size_t i) const { return objects.data() + offsets[i]; }
+
+      void push_back(int predicate, const std::vector<int> &atom_objects);
+
+      bool operator==(const PackedAtoms &other) const {
+        return predicates == other.predicates && objects == other.objects &&
+               offsets == other.offsets;
+      }
+    };
+
+    // Interned ids of the predicates of a domain and the objects of a problem. Predicate ids are
+    // those of Domain::predicate_to_colour and object ids list constant objects first, so that
+    // they coincide with the object nodes of graph representations.
+    class SymbolTable {
+      std::vector<Predicate> predicates;
+      std::vector<Object> objects;
+      std::unordered_map<std::string, int> predicate_to_id;
+      std::unordered_map<Object, int> object_to_id;
+      std::vector<uint64_t> predicate_hashes;
+      std::vector<uint64_t> object_hashes;
+
+     public:
+      SymbolTable(const std::vector<Predicate> &predicates,
+                  const std::unordered_map<std::string, int> &predicate_to_id,
+                  const std::vector<Object> &objects);
+
+      int get_n_predicates() const { return predicates.size(); }
+      int get_n_objects() const { return objects.size(); }
+      const Predicate &get_predicate(int id) const { return predicates.at(id); }
+      const Object &get_object(int id) const { return objects.at(id); }
+      const std::vector<Object> &get_objects() const { return objects; }
+      const std::unordered_map<std::string, int> &get_predicate_to_id() const {
+        return predicate_to_id;
+      }
+      const std::unordered_map<Object, int> &get_object_to_id() const { return object_to_id; }
+      int get_predicate_id(const std::string &predicate_name) const {
+        return predicate_to_id.at(predicate_name);
+      }
+      int get_object_id(const Object &object) const { return object_to_id.at(object); }
+
+      // conversion between atoms and packed atoms; throws std::out_of_range for unknown symbols
+      PackedAtoms pack(const std::vector<Atom> &atoms) const;
+      Atom unpack(const PackedAtoms &atoms, size_t i) const;
+
+      // throws std::runtime_error if offsets or ids are out of range or do not match predicate
+      // arities
+      void check_packed(const PackedAtoms &atoms) const;
+
+      // Zobrist keys of atoms from hashes of their symbol names, so that keys of packed atoms
+      // coincide with those of atoms with the same names
+      static uint64_t name_hash(const std::string &name);
+      static uint64_t atom_key(const Atom &atom);
+      uint64_t atom_key(const PackedAtoms &atoms, size_t i) const;
+
+      bool operator==(const SymbolTable &other) const {
+        return predicates == other.predicates && objects == other.objects;
+      }
+    };
+  }  // namespace planning
+}  // namespace wlplan
+
+#endif  // PLANNING_SYMBOL_TABLE_HPP
@@ -6,6 +6,8 @@
 #include <pybind11/stl.h>
 #include <pybind11/typing.h>
 
+#include <memory>
+
 namespace py = pybind11;
 
 template <typename T>
@@ -14,4 +16,28 @@ py::tuple __getstate__(const T &input);
 template <typename T>
 T __setstate__(py::tuple t);
 
+// Pickles the binary form of input, which is handed out of band as a PickleBuffer for protocol
+// 5 and above. The result calls from_buffer with the buffer to unpickle.
+template <typename T>
+py::tuple __reduce_ex__(const T &input, int protocol, const py::object &from_buffer);
+
+template <typename T>
+T __from_buffer__(const py::buffer &buffer);
+
+namespace wlplan {
+  namespace planning {
+    class State;
+    class SymbolTable;
+  }  // namespace planning
+}  // namespace wlplan
+
+// States are pickled as their symbol table and the binary form of their atom ids into it. Pickle
+// memoises the table, so states of one problem pickled together share a single table.
+py::tuple
+__reduce_ex__(const wlplan::planning::State &input, int protocol, const py::object &from_buffer);
+
+wlplan::planning::State
+__state_from_buffer__(const std::shared_ptr<wlplan::planning::SymbolTable> &symbol_table,
+                      const py::buffer &buffer);
+
 #endif  // UTILS_SERIALISE_HPP
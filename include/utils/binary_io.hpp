@@ -0,0 +1,144 @@
+#ifndef UTILS_BINARY_IO_HPP
+#define UTILS_BINARY_IO_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace wlplan {
+  namespace utils {
+    // Writes native integers, length prefixed strings and arrays to a stream or a string. Array
+    // data is aligned to 8 bytes relative to the start so that it can be used in place.
+    class BinaryWriter {
+      std::ostream *out = nullptr;
+      std::string *buffer = nullptr;
+      size_t pos = 0;
+
+     public:
+      BinaryWriter(std::ostream &out) : out(&out) {}
+      BinaryWriter(std::string &buffer) : buffer(&buffer) {}
+
+      void write_raw(const void *data, size_t size) {
+        if (out != nullptr) {
+          out->write(static_cast<const char *>(data), size);
+        } else {
+          buffer->append(static_cast<const char *>(data), size);
+        }
+        pos += size;
+      }
+
+      template <typename T>
+      void write(T value) {
+        write_raw(&value, sizeof(T));
+      }
+
+      void write_string(const std::string &str) {
+        write<uint64_t>(str.size());
+        write_raw(str.data(), str.size());
+      }
+
+      void write_strings(const std::vector<std::string> &strs) {
+        write<uint64_t>(strs.size());
+        for (const std::string &str : strs) {
+          write_string(str);
+        }
+      }
+
+      template <typename T>
+      void write_array(const T *data, size_t n) {
+        write<uint64_t>(n);
+        const char padding[8] = {0};
+        write_raw(padding, (8 - pos % 8) % 8);
+        write_raw(data, n * sizeof(T));
+      }
+
+      template <typename T>
+      void write_vector(const std::vector<T> &vec) {
+        write_array(vec.data(), vec.size());
+      }
+    };
+
+    // Reads what BinaryWriter writes from memory, throwing std::runtime_error on truncated
+    // input. If an owner of the memory is given, arrays can be viewed in place.
+    class BinaryReader {
+      std::shared_ptr<const void> owner;
+      const char *base;
+      size_t size;
+      size_t pos = 0;
+
+     public:
+      BinaryReader(const char *data, size_t size) : base(data), size(size) {}
+      BinaryReader(const std::shared_ptr<const void> &owner, size_t size)
+          : owner(owner), base(static_cast<const char *>(owner.get())), size(size) {}
+
+      const std::shared_ptr<const void> &get_owner() const { return owner; }
+      bool done() const { return pos == size; }
+
+      const char *read_raw(size_t n) {
+        if (n > size - pos) {
+          throw std::runtime_error("Binary input is truncated");
+        }
+        const char *ret = base + pos;
+        pos += n;
+        return ret;
+      }
+
+      template <typename T>
+      T read() {
+        T ret;
+        std::memcpy(&ret, read_raw(sizeof(T)), sizeof(T));
+        return ret;
+      }
+
+      // reads a number of items that each take at least one byte, so that malformed input
+      // cannot cause large allocations
+      size_t read_count() {
+        uint64_t n = read<uint64_t>();
+        if (n > size - pos) {
+          throw std::runtime_error("Binary input is truncated");
+        }
+        return n;
+      }
+
+      std::string read_bytes(size_t n) { return std::string(read_raw(n), n); }
+
+      std::string read_string() { return read_bytes(read<uint64_t>()); }
+
+      std::vector<std::string> read_strings() {
+        std::vector<std::string> ret(read_count());
+        for (std::string &str : ret) {
+          str = read_string();
+        }
+        return ret;
+      }
+
+      // returns a pointer to n elements of an array, which is only aligned if the input is
+      template <typename T>
+      const T *read_array(size_t &n) {
+        n = read<uint64_t>();
+        read_raw((8 - pos % 8) % 8);
+        if (n > (size - pos) / sizeof(T)) {
+          throw std::runtime_error("Binary input is truncated");
+        }
+        return reinterpret_cast<const T *>(read_raw(n * sizeof(T)));
+      }
+
+      template <typename T>
+      std::vector<T> read_vector() {
+        size_t n;
+        const T *data = read_array<T>(n);
+        std::vector<T> ret(n);
+        if (n > 0) {
+          std::memcpy(ret.data(), data, n * sizeof(T));
+        }
+        return ret;
+      }
+    };
+  }  // namespace utils
+}  // namespace wlplan
+
+#endif  // UTILS_BINARY_IO_HPP
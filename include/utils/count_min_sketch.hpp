@@ -0,0 +1,49 @@
+#ifndef UTILS_COUNT_MIN_SKETCH_HPP
+#define UTILS_COUNT_MIN_SKETCH_HPP
+
+#include "hashing.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#define COUNT_MIN_SKETCH_DEPTH 4
+
+namespace wlplan {
+  namespace utils {
+    // Count-min sketch of counts of int keys in COUNT_MIN_SKETCH_DEPTH rows of width counters.
+    // Estimates are never below the true count, and exceed it by at most 2/width of the total
+    // count with probability 1 - 1/2^depth.
+    class CountMinSketch {
+      long width;
+      std::vector<long> table;
+
+      inline size_t index(int row, int key) const {
+        return row * width + mix_pair(row, key) % width;
+      }
+
+     public:
+      CountMinSketch() : CountMinSketch(1) {}
+
+      CountMinSketch(long width) : width(width), table(width * COUNT_MIN_SKETCH_DEPTH, 0) {}
+
+      void add(int key, long count) {
+        for (int row = 0; row < COUNT_MIN_SKETCH_DEPTH; row++) {
+          table[index(row, key)] += count;
+        }
+      }
+
+      long estimate(int key) const {
+        long ret = std::numeric_limits<long>::max();
+        for (int row = 0; row < COUNT_MIN_SKETCH_DEPTH; row++) {
+          ret = std::min(ret, table[index(row, key)]);
+        }
+        return ret;
+      }
+
+      void clear() { std::fill(table.begin(), table.end(), 0); }
+    };
+  }  // namespace utils
+}  // namespace wlplan
+
+#endif  // UTILS_COUNT_MIN_SKETCH_HPP
@@ -0,0 +1,42 @@
+#ifndef UTILS_HASHING_HPP
+#define UTILS_HASHING_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace wlplan {
+  namespace utils {
+    // splitmix64 finaliser, a bijective mixer with good avalanche behaviour
+    inline uint64_t mix64(uint64_t x) {
+      x += 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+
+    // mixed hash of an ordered pair of ints
+    inline uint64_t mix_pair(int a, int b) {
+      return mix64(((uint64_t)(uint32_t)a << 32) | (uint32_t)b);
+    }
+
+    // hash functor of int vectors, e.g. of a predicate id followed by object ids
+    struct IntVectorHash {
+      std::size_t operator()(const std::vector<int> &vec) const {
+        uint64_t h = vec.size();
+        for (const int i : vec) {
+          h = mix64(h ^ (uint32_t)i);
+        }
+        return h;
+      }
+    };
+
+    // split a 64-bit hash into an int vector {hi, lo}, e.g. for use as a colour hash key
+    inline void to_int_pair(uint64_t h, std::vector<int> &out) {
+      out.resize(2);
+      out[0] = (int)(uint32_t)(h >> 32);
+      out[1] = (int)(uint32_t)h;
+    }
+  }  // namespace utils
+}  // namespace wlplan
+
+#endif  // UTILS_HASHING_HPP
@@ -0,0 +1,471 @@
+#include "../../include/data/columnar_dataset.hpp"
+
+#include "../../include/planning/binary_format.hpp"
+#include "../../include/utils/hashing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define COLUMNAR_MAGIC "WLPLANCD"
+#define COLUMNAR_FORMAT_VERSION 1
+// written natively so that files from machines with another byte order are rejected
+#define COLUMNAR_BYTE_ORDER 0x01020304u
+
+namespace wlplan {
+  namespace data {
+    namespace {
+      using IdMap = std::unordered_map<std::vector<int>, int, utils::IntVectorHash>;
+
+      int intern(IdMap &ids, const std::vector<int> &key) {
+        return ids.emplace(key, (int)ids.size()).first->second;
+      }
+
+      ColumnarProblem to_columns(const planning::Domain &domain, const ProblemDataset &dataset) {
+        const planning::Problem &problem = dataset.problem;
+        std::shared_ptr<const planning::SymbolTable> symbol_table = problem.get_symbol_table();
+        ColumnarProblem ret(problem);
+
+        // atoms
+        IdMap atom_to_id;
+        std::vector<int> atom_predicates, atom_objects, atom_offsets = {0};
+        std::vector<uint8_t> keyframes;
+        std::vector<int> state_atoms, state_offsets = {0};
+        std::vector<double> values;
+        std::vector<int> key, ids, prev_ids, added, deleted;
+        int n_deltas = 0;
+        if (!dataset.states.empty()) {
+          ret.n_values = dataset.states[0].get_values().size();
+        }
+
+        for (const planning::State &state : dataset.states) {
+          const planning::PackedAtoms packed =
+              state.is_packed() ? state.packed_atoms : symbol_table->pack(state.get_atoms());
+          ids.clear();
+          for (size_t a = 0; a < packed.size(); a++) {
+            const int *objects = packed.get_objects(a);
+            key.assign({packed.predicates[a]});
+            key.insert(key.end(), objects, objects + packed.get_arity(a));
+            int id = intern(atom_to_id, key);
+            if (id == (int)atom_predicates.size()) {
+              atom_predicates.push_back(key[0]);
+              atom_objects.insert(atom_objects.end(), key.begin() + 1, key.end());
+              atom_offsets.push_back(atom_objects.size());
+            }
+            ids.push_back(id);
+          }
+          std::sort(ids.begin(), ids.end());
+          ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+          added.clear();
+          deleted.clear();
+          std::set_difference(ids.begin(),
+                              ids.end(),
+                              prev_ids.begin(),
+                              prev_ids.end(),
+                              std::back_inserter(added));
+          std::set_difference(prev_ids.begin(),
+                              prev_ids.end(),
+                              ids.begin(),
+                              ids.end(),
+                              std::back_inserter(deleted));
+          bool keyframe = keyframes.empty() || n_deltas + 1 >= COLUMNAR_KEYFRAME_INTERVAL ||
+                          added.size() + deleted.size() >= ids.size();
+          if (keyframe) {
+            state_atoms.insert(state_atoms.end(), ids.begin(), ids.end());
+            n_deltas = 0;
+          } else {
+            state_atoms.insert(state_atoms.end(), added.begin(), added.end());
+            for (int id : deleted) {
+              state_atoms.push_back(~id);
+            }
+            n_deltas++;
+          }
+          keyframes.push_back(keyframe);
+          state_offsets.push_back(state_atoms.size());
+          std::swap(ids, prev_ids);
+
+          if ((int)state.get_values().size() != ret.n_values) {
+            throw std::runtime_error("States of a problem must have the same number of values");
+          }
+          values.insert(values.end(), state.get_values().begin(), state.get_values().end());
+        }
+
+        // actions
+        std::unordered_map<std::string, int> schema_to_id;
+        for (size_t i = 0; i < domain.schemata.size(); i++) {
+          schema_to_id[domain.schemata[i].name] = i;
+        }
+        IdMap action_to_id;
+        std::vector<int> action_schemata, action_objects, action_offsets = {0};
+        std::vector<int> state_actions, state_action_offsets = {0};
+        for (const planning::Actions &actions : dataset.actions) {
+          for (const planning::Action &action : actions) {
+            auto it = schema_to_id.find(action.schema->name);
+            if (it == schema_to_id.end()) {
+              throw std::runtime_error("Unknown schema " + action.schema->name);
+            }
+            key.assign({it->second});
+            for (const planning::Object &object : action.objects) {
+              key.push_back(symbol_table->get_object_id(object));
+            }
+            int id = intern(action_to_id, key);
+            if (id == (int)action_schemata.size()) {
+              action_schemata.push_back(key[0]);
+              action_objects.insert(action_objects.end(), key.begin() + 1, key.end());
+              action_offsets.push_back(action_objects.size());
+            }
+            state_actions.push_back(id);
+          }
+          state_action_offsets.push_back(state_actions.size());
+        }
+
+        ret.atom_predicates = Column<int>(std::move(atom_predicates));
+        ret.atom_objects = Column<int>(std::move(atom_objects));
+        ret.atom_offsets = Column<int>(std::move(atom_offsets));
+        ret.keyframes = Column<uint8_t>(std::move(keyframes));
+        ret.state_atoms = Column<int>(std::move(state_atoms));
+        ret.state_offsets = Column<int>(std::move(state_offsets));
+        ret.values = Column<double>(std::move(values));
+        ret.action_schemata = Column<int>(std::move(action_schemata));
+        ret.action_objects = Column<int>(std::move(action_objects));
+        ret.action_offsets = Column<int>(std::move(action_offsets));
+        ret.state_actions = Column<int>(std::move(state_actions));
+        ret.state_action_offsets = Column<int>(std::move(state_action_offsets));
+        return ret;
+      }
+
+      template <typename T>
+      void write_column(utils::BinaryWriter &writer, const Column<T> &column) {
+        writer.write_array(column.data(), column.size());
+      }
+
+      // views columns in place if the reader owns memory mapped input, and otherwise copies them
+      template <typename T>
+      Column<T> read_column(utils::BinaryReader &reader) {
+        if (reader.get_owner() == nullptr) {
+          return Column<T>(reader.read_vector<T>());
+        }
+        size_t n;
+        const T *data = reader.read_array<T>(n);
+        return Column<T>(reader.get_owner(), data, n);
+      }
+
+      std::shared_ptr<const void> map_file(const std::string &path, size_t &size) {
+#ifdef _WIN32
+        // no mmap, so the file is read into memory instead
+        std::ifstream in(path, std::ios::binary);
+        if (!in.good()) {
+          throw std::runtime_error("Cannot open " + path);
+        }
+        auto data = std::make_shared<std::vector<char>>(std::istreambuf_iterator<char>(in),
+                                                        std::istreambuf_iterator<char>());
+        size = data->size();
+        return std::shared_ptr<const void>(data, data->data());
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+          throw std::runtime_error("Cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+          close(fd);
+          throw std::runtime_error("Cannot stat " + path);
+        }
+        size = st.st_size;
+        if (size == 0) {
+          close(fd);
+          throw std::runtime_error("Binary input is truncated");
+        }
+        void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) {
+          throw std::runtime_error("Cannot mmap " + path);
+        }
+        return std::shared_ptr<const void>(addr, [size](const void *p) {
+          munmap(const_cast<void *>(p), size);
+        });
+#endif
+      }
+
+      // checks that a table of ids with objects refers to valid symbols
+      void check_table(const Column<int> &heads,
+                       const Column<int> &objects,
+                       const Column<int> &offsets,
+                       int n_heads,
+                       int n_objects) {
+        if (offsets.size() != heads.size() + 1 || offsets[0] != 0 ||
+            offsets[heads.size()] != (int)objects.size()) {
+          throw std::runtime_error("Columnar dataset has inconsistent offsets");
+        }
+        for (size_t i = 0; i < heads.size(); i++) {
+          if (heads[i] < 0 || heads[i] >= n_heads || offsets[i + 1] < offsets[i]) {
+            throw std::runtime_error("Columnar dataset has invalid ids");
+          }
+        }
+        for (size_t i = 0; i < objects.size(); i++) {
+          if (objects[i] < 0 || objects[i] >= n_objects) {
+            throw std::runtime_error("Columnar dataset has invalid object ids");
+          }
+        }
+      }
+
+      void check_offsets(const Column<int> &offsets, size_t n, size_t n_entries) {
+        if (offsets.size() != n + 1 || offsets[0] != 0 || offsets[n] != (int)n_entries) {
+          throw std::runtime_error("Columnar dataset has inconsistent offsets");
+        }
+        for (size_t i = 0; i < n; i++) {
+          if (offsets[i + 1] < offsets[i]) {
+            throw std::runtime_error("Columnar dataset has decreasing offsets");
+          }
+        }
+      }
+    }  // namespace
+
+    ColumnarDataset::ColumnarDataset(const planning::Domain &domain,
+                                     std::vector<ColumnarProblem> &&problems)
+        : domain(domain), problems(std::move(problems)) {}
+
+    ColumnarDataset::ColumnarDataset(const DomainDataset &dataset) : domain(dataset.domain) {
+      problems.reserve(dataset.data.size());
+      for (const ProblemDataset &problem_dataset : dataset.data) {
+        problems.push_back(to_columns(domain, problem_dataset));
+      }
+    }
+
+    void ColumnarDataset::write(utils::BinaryWriter &writer) const {
+      writer.write_raw(COLUMNAR_MAGIC, 8);
+      writer.write<uint32_t>(COLUMNAR_FORMAT_VERSION);
+      writer.write<uint32_t>(COLUMNAR_BYTE_ORDER);
+      planning::write_domain(writer, domain);
+      writer.write<uint64_t>(problems.size());
+      for (const ColumnarProblem &data : problems) {
+        planning::write_problem(writer, data.problem);
+        writer.write<int32_t>(data.n_values);
+        write_column(writer, data.atom_predicates);
+        write_column(writer, data.atom_objects);
+        write_column(writer, data.atom_offsets);
+        write_column(writer, data.keyframes);
+        write_column(writer, data.state_atoms);
+        write_column(writer, data.state_offsets);
+        write_column(writer, data.values);
+        write_column(writer, data.action_schemata);
+        write_column(writer, data.action_objects);
+        write_column(writer, data.action_offsets);
+        write_column(writer, data.state_actions);
+        write_column(writer, data.state_action_offsets);
+      }
+    }
+
+    void ColumnarDataset::save(const std::string &path) const {
+      std::ofstream out(path, std::ios::binary);
+      if (!out.good()) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+      }
+      utils::BinaryWriter writer(out);
+      write(writer);
+      out.close();
+      if (!out.good()) {
+        throw std::runtime_error("Failed to write " + path);
+      }
+    }
+
+    ColumnarDataset ColumnarDataset::read(utils::BinaryReader &reader) {
+      if (reader.read_bytes(8) != COLUMNAR_MAGIC) {
+        throw std::runtime_error("Input is not a columnar dataset");
+      }
+      if (reader.read<uint32_t>() != COLUMNAR_FORMAT_VERSION ||
+          reader.read<uint32_t>() != COLUMNAR_BYTE_ORDER) {
+        throw std::runtime_error("Columnar dataset has an unsupported version or byte order");
+      }
+
+      auto domain = std::make_shared<const planning::Domain>(planning::read_domain(reader));
+      std::vector<ColumnarProblem> problems;
+      size_t n_problems = reader.read_count();
+      for (size_t i = 0; i < n_problems; i++) {
+        ColumnarProblem data(planning::read_problem(reader, domain));
+        data.n_values = reader.read<int32_t>();
+        data.atom_predicates = read_column<int>(reader);
+        data.atom_objects = read_column<int>(reader);
+        data.atom_offsets = read_column<int>(reader);
+        data.keyframes = read_column<uint8_t>(reader);
+        data.state_atoms = read_column<int>(reader);
+        data.state_offsets = read_column<int>(reader);
+        data.values = read_column<double>(reader);
+        data.action_schemata = read_column<int>(reader);
+        data.action_objects = read_column<int>(reader);
+        data.action_offsets = read_column<int>(reader);
+        data.state_actions = read_column<int>(reader);
+        data.state_action_offsets = read_column<int>(reader);
+
+        // tables and offsets are checked here, and atom ids of states when they are decoded
+        const std::shared_ptr<const planning::SymbolTable> symbol_table =
+            data.problem.get_symbol_table();
+        check_table(data.atom_predicates,
+                    data.atom_objects,
+                    data.atom_offsets,
+                    symbol_table->get_n_predicates(),
+                    symbol_table->get_n_objects());
+        check_table(data.action_schemata,
+                    data.action_objects,
+                    data.action_offsets,
+                    domain->schemata.size(),
+                    symbol_table->get_n_objects());
+        size_t n_states = data.get_size();
+        check_offsets(data.state_offsets, n_states, data.state_atoms.size());
+        check_offsets(data.state_action_offsets, n_states, data.state_actions.size());
+        if (data.n_values < 0 || data.values.size() != n_states * data.n_values ||
+            (n_states > 0 && !data.keyframes[0])) {
+          throw std::runtime_error("Columnar dataset has inconsistent states");
+        }
+        problems.push_back(std::move(data));
+      }
+      return ColumnarDataset(*domain, std::move(problems));
+    }
+
+    ColumnarDataset ColumnarDataset::load(const std::string &path) {
+      size_t size;
+      std::shared_ptr<const void> mapping = map_file(path, size);
+      utils::BinaryReader reader(mapping, size);
+      return read(reader);
+    }
+
+    size_t ColumnarDataset::get_size() const {
+      size_t ret = 0;
+      for (const ColumnarProblem &data : problems) {
+        ret += data.get_size();
+      }
+      return ret;
+    }
+
+    void ColumnarDataset::apply_state(const ColumnarProblem &data,
+                                      size_t i,
+                                      std::vector<int> &true_ids) {
+      std::vector<std::pair<int, bool>> delta;
+      delta.reserve(data.state_offsets[i + 1] - data.state_offsets[i]);
+      for (int r = data.state_offsets[i]; r < data.state_offsets[i + 1]; r++) {
+        int entry = data.state_atoms[r];
+        int id = entry >= 0 ? entry : ~entry;
+        if (id >= (int)data.atom_predicates.size()) {
+          throw std::runtime_error("Columnar dataset has invalid atom ids");
+        }
+        delta.push_back({id, entry >= 0});
+      }
+      std::stable_sort(delta.begin(), delta.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+      });
+
+      // merges the delta into the previous ids, where the last entry of an atom wins
+      std::vector<int> ret;
+      ret.reserve(data.keyframes[i] ? delta.size() : true_ids.size() + delta.size());
+      size_t a = data.keyframes[i] ? true_ids.size() : 0;
+      for (size_t d = 0; d < delta.size(); d++) {
+        if (d + 1 < delta.size() && delta[d + 1].first == delta[d].first) {
+          continue;
+        }
+        for (; a < true_ids.size() && true_ids[a] < delta[d].first; a++) {
+          ret.push_back(true_ids[a]);
+        }
+        if (a < true_ids.size() && true_ids[a] == delta[d].first) {
+          a++;
+        }
+        if (delta[d].second) {
+          ret.push_back(delta[d].first);
+        }
+      }
+      ret.insert(ret.end(), true_ids.begin() + a, true_ids.end());
+      true_ids.swap(ret);
+    }
+
+    planning::State ColumnarDataset::to_state(const ColumnarProblem &data,
+                                              size_t i,
+                                              const std::vector<int> &true_ids) {
+      planning::PackedAtoms atoms;
+      atoms.predicates.reserve(true_ids.size());
+      atoms.offsets.reserve(true_ids.size() + 1);
+      for (int a : true_ids) {
+        atoms.predicates.push_back(data.atom_predicates[a]);
+        atoms.objects.insert(atoms.objects.end(),
+                             data.atom_objects.data() + data.atom_offsets[a],
+                             data.atom_objects.data() + data.atom_offsets[a + 1]);
+        atoms.offsets.push_back(atoms.objects.size());
+      }
+      const double *values = data.values.data() + i * data.n_values;
+      return planning::State(data.problem.get_symbol_table(),
+                             atoms,
+                             std::vector<double>(values, values + data.n_values));
+    }
+
+    std::vector<planning::State> ColumnarDataset::get_states(size_t i) const {
+      const ColumnarProblem &data = problems.at(i);
+      std::vector<int> true_ids;
+      std::vector<planning::State> ret;
+      ret.reserve(data.get_size());
+      for (size_t j = 0; j < data.get_size(); j++) {
+        apply_state(data, j, true_ids);
+        ret.push_back(to_state(data, j, true_ids));
+      }
+      return ret;
+    }
+
+    planning::State ColumnarDataset::get_state(size_t i, size_t j) const {
+      const ColumnarProblem &data = problems.at(i);
+      if (j >= data.get_size()) {
+        throw std::out_of_range("State index " + std::to_string(j) + " out of range");
+      }
+      size_t keyframe = j;
+      while (!data.keyframes[keyframe]) {
+        keyframe--;
+      }
+      std::vector<int> true_ids;
+      for (size_t k = keyframe; k <= j; k++) {
+        apply_state(data, k, true_ids);
+      }
+      return to_state(data, j, true_ids);
+    }
+
+    std::vector<planning::Actions> ColumnarDataset::get_actions(size_t i) const {
+      const ColumnarProblem &data = problems.at(i);
+      const std::shared_ptr<const planning::SymbolTable> symbol_table =
+          data.problem.get_symbol_table();
+      std::vector<planning::Actions> ret(data.get_size());
+      for (size_t j = 0; j < data.get_size(); j++) {
+        for (int r = data.state_action_offsets[j]; r < data.state_action_offsets[j + 1]; r++) {
+          int id = data.state_actions[r];
+          if (id < 0 || id >= (int)data.action_schemata.size()) {
+            throw std::runtime_error("Columnar dataset has invalid action ids");
+          }
+          std::vector<planning::Object> objects;
+          for (int o = data.action_offsets[id]; o < data.action_offsets[id + 1]; o++) {
+            objects.push_back(symbol_table->get_object(data.action_objects[o]));
+          }
+          ret[j].push_back(planning::Action(domain.schemata[data.action_schemata[id]], objects));
+        }
+      }
+      return ret;
+    }
+
+    ProblemDataset ColumnarDataset::get_problem_dataset(size_t i) const {
+      return ProblemDataset(get_problem(i), get_states(i), get_actions(i));
+    }
+
+    DomainDataset ColumnarDataset::to_domain_dataset() const {
+      std::vector<ProblemDataset> data;
+      data.reserve(problems.size());
+      for (size_t i = 0; i < problems.size(); i++) {
+        data.push_back(get_problem_dataset(i));
+      }
+      return DomainDataset(domain, data);
+    }
+  }  // namespace data
+}  // namespace wlplan
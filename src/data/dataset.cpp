@@ -57,6 +57,14 @@ namespace wlplan {
 
         // check proposition consistency of states
         for (const planning::State &state : states) {
+          if (state.is_packed()) {
+            if (state.symbol_table != problem.get_symbol_table() &&
+                !(*state.symbol_table == *problem.get_symbol_table())) {
+              throw std::runtime_error(
+                  "Packed state was built from the symbols of another problem");
+            }
+            state.symbol_table->check_packed(state.packed_atoms);
+          }
           for (const std::shared_ptr<planning::Atom> &atom : state.atoms) {
             check_good_atom(*atom, objects);
           }
@@ -3,6 +3,7 @@
 #include "../../include/feature_generator/feature_generators/ccwl.hpp"
 #include "../../include/feature_generator/feature_generators/ccwla.hpp"
 #include "../../include/feature_generator/feature_generators/iwl.hpp"
+#include "../../include/feature_generator/feature_generators/kwl2.hpp"
 #include "../../include/feature_generator/feature_generators/lwl2.hpp"
 #include "../../include/feature_generator/feature_generators/niwl.hpp"
 #include "../../include/feature_generator/feature_generators/wl.hpp"
@@ -37,3 +38,26 @@ load_feature_generator(const std::string save_file) {
   std::cout << "Feature generator loaded!" << std::endl;
   return feature_generator;
 }
+
+std::unique_ptr<wlplan::feature_generator::Features>
+read_feature_generator(wlplan::utils::BinaryReader &reader) {
+  // the binary form starts with the feature name, which is peeked at with a copy of the reader
+  wlplan::utils::BinaryReader peek = reader;
+  std::string feature_name = peek.read_string();
+  if (feature_name == "wl") {
+    return std::make_unique<wlplan::feature_generator::WLFeatures>(reader);
+  } else if (feature_name == "2-kwl") {
+    return std::make_unique<wlplan::feature_generator::KWL2Features>(reader);
+  } else if (feature_name == "2-lwl") {
+    return std::make_unique<wlplan::feature_generator::LWL2Features>(reader);
+  } else if (feature_name == "ccwl") {
+    return std::make_unique<wlplan::feature_generator::CCWLFeatures>(reader);
+  } else if (feature_name == "ccwl-a") {
+    return std::make_unique<wlplan::feature_generator::CCWLaFeatures>(reader);
+  } else if (feature_name == "iwl") {
+    return std::make_unique<wlplan::feature_generator::IWLFeatures>(reader);
+  } else if (feature_name == "niwl") {
+    return std::make_unique<wlplan::feature_generator::NIWLFeatures>(reader);
+  }
+  throw std::runtime_error("Feature name " + feature_name + " not recognised.");
+}
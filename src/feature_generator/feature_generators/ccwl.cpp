@@ -35,7 +35,9 @@ namespace wlplan {
     CCWLFeatures::CCWLFeatures(const std::string &filename, bool quiet)
         : WLFeatures(filename, quiet) {}
 
-    int CCWLFeatures::get_n_features() const { return get_n_colours() * 2; }
+    CCWLFeatures::CCWLFeatures(utils::BinaryReader &reader) : WLFeatures(reader) {}
+
+    long CCWLFeatures::get_n_features() const { return 2L * get_n_colours(); }
 
     Embedding CCWLFeatures::embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
       // New additions to the WL algorithm are indicated with the [NUMERIC] comments.
@@ -44,7 +46,7 @@ namespace wlplan {
 
       /* 1. Initialise embedding before pruning, and set up memory */
       int categorical_size = get_n_colours();
-      Embedding x0(get_n_features(), 0);
+      Embedding x0(categorical_size * 2, 0);  // subclasses may append more features
       int n_nodes = graph->nodes.size();
       std::vector<int> colours(n_nodes);
       std::set<int> nodes = graph->get_nodes_set();
@@ -58,8 +60,8 @@ namespace wlplan {
         is_seen_colour = (col != UNSEEN_COLOUR);  // prevent branch prediction
         seen_colour_statistics[is_seen_colour][0]++;
         if (is_seen_colour) {
-          x0[col]++;
-          x0[col + categorical_size] += graph->node_values[node_i];  // [NUMERIC]
+          add_to_feature(col, 1, x0);
+          add_to_feature(col, graph->node_values[node_i], x0, categorical_size);  // [NUMERIC]
         }
       }
 
@@ -71,8 +73,8 @@ namespace wlplan {
           is_seen_colour = (col != UNSEEN_COLOUR);  // prevent branch prediction
           seen_colour_statistics[is_seen_colour][itr]++;
           if (is_seen_colour) {
-            x0[col]++;
-            x0[col + categorical_size] += graph->node_values[node_i];  // [NUMERIC]
+            add_to_feature(col, 1, x0);
+            add_to_feature(col, graph->node_values[node_i], x0, categorical_size);  // [NUMERIC]
           }
         }
       }
@@ -24,25 +24,124 @@ namespace wlplan {
     CCWLaFeatures::CCWLaFeatures(const std::string &filename, bool quiet)
         : CCWLFeatures(filename, quiet) {}
 
-    int CCWLaFeatures::get_n_features() const {
-      int n_cat_features = get_n_colours();
-      int n_con_features = get_n_colours();
-      int n_sub_features = n_con_features * (n_con_features - 1);
+    CCWLaFeatures::CCWLaFeatures(utils::BinaryReader &reader) : CCWLFeatures(reader) {}
+
+    long CCWLaFeatures::get_n_features() const {
+      long n_cat_features = get_n_colours();
+      long n_con_features = get_n_colours();
+      long n_sub_features = selected_pairs.empty() ? n_con_features * (n_con_features - 1)
+                                                   : (long)selected_pairs.size();
       return n_cat_features + n_con_features + n_sub_features;
     }
 
+    void CCWLaFeatures::set_selected_pairs(const std::vector<std::pair<int, int>> &pairs) {
+      if (!collected) {
+        throw std::runtime_error("collect() must be called before selecting pairs");
+      }
+      if (store_weights) {
+        throw std::runtime_error("Cannot change the selected pairs after weights are set");
+      }
+      int n_colours = get_n_colours();
+      for (const auto &[i, j] : pairs) {
+        if (i < 0 || j < 0 || i >= n_colours || j >= n_colours || i == j) {
+          throw std::runtime_error("Invalid colour pair (" + std::to_string(i) + ", " +
+                                   std::to_string(j) + ") for " + std::to_string(n_colours) +
+                                   " colours");
+        }
+      }
+      selected_pairs = pairs;
+    }
+
+    long CCWLaFeatures::get_pair_feature_index(int i, int j) const {
+      long n_colours = get_n_colours();
+      return 2 * n_colours + i * (n_colours - 1) + (j < i ? j : j - 1);
+    }
+
+    // Pair features are only active when both continuous features are non-zero, so that the
+    // number of non-zero pair features depends on the state and not the dictionary size.
+    inline double pair_feature(double x_i, double x_j) {
+      if (x_i == 0 || x_j == 0) {
+        return 0;
+      }
+      return std::max(x_i - x_j, 0.0);
+    }
+
     Embedding CCWLaFeatures::embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
       Embedding ccwl_embedding = CCWLFeatures::embed_impl(graph);
       int n_con_features = get_n_colours();  // = n_cat_features
+      const double *con = ccwl_embedding.data() + n_con_features;
+      ccwl_embedding.reserve(get_n_features());
+      if (!selected_pairs.empty()) {
+        for (const auto &[i, j] : selected_pairs) {
+          ccwl_embedding.push_back(pair_feature(con[i], con[j]));
+        }
+        return ccwl_embedding;
+      }
+
+      ccwl_embedding.resize(get_n_features(), 0);
+      con = ccwl_embedding.data() + n_con_features;  // resize may reallocate
+      std::vector<int> non_zero;
       for (int i = 0; i < n_con_features; i++) {
-        for (int j = 0; j < n_con_features; j++) {
+        if (con[i] != 0)
+          non_zero.push_back(i);
+      }
+      for (const int i : non_zero) {
+        for (const int j : non_zero) {
           if (i == j)
             continue;
-          ccwl_embedding.push_back(std::max(ccwl_embedding[i] - ccwl_embedding[j], 0.0));
+          ccwl_embedding[get_pair_feature_index(i, j)] = pair_feature(con[i], con[j]);
         }
       }
 
       return ccwl_embedding;
     }
+
+    SparseEmbedding
+    CCWLaFeatures::embed_sparse_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
+      Embedding ccwl_embedding = CCWLFeatures::embed_impl(graph);
+      int n_con_features = get_n_colours();
+      const double *con = ccwl_embedding.data() + n_con_features;
+
+      SparseEmbedding ret;
+      std::vector<int> non_zero;
+      for (int i = 0; i < 2 * n_con_features; i++) {
+        if (ccwl_embedding[i] != 0) {
+          ret.push_back(std::make_pair(i, ccwl_embedding[i]));
+          if (i >= n_con_features)
+            non_zero.push_back(i - n_con_features);
+        }
+      }
+
+      if (!selected_pairs.empty()) {
+        for (size_t k = 0; k < selected_pairs.size(); k++) {
+          const auto &[i, j] = selected_pairs[k];
+          double value = pair_feature(con[i], con[j]);
+          if (value != 0)
+            ret.push_back(std::make_pair(2 * n_con_features + k, value));
+        }
+        return ret;
+      }
+
+      for (const int i : non_zero) {
+        for (const int j : non_zero) {
+          if (i == j)
+            continue;
+          double value = pair_feature(con[i], con[j]);
+          if (value != 0)
+            ret.push_back(std::make_pair(get_pair_feature_index(i, j), value));
+        }
+      }
+
+      return ret;
+    }
+
+    double CCWLaFeatures::predict_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
+      // evaluate pair terms directly against the weights instead of building the embedding
+      double h = 0;
+      for (const auto &[index, value] : embed_sparse_impl(graph)) {
+        h += value * get_weight(index);
+      }
+      return h;
+    }
   }  // namespace feature_generator
 }  // namespace wlplan
@@ -36,6 +36,8 @@ namespace wlplan {
     IWLFeatures::IWLFeatures(const std::string &filename, bool quiet)
         : WLFeatures(filename, quiet) {}
 
+    IWLFeatures::IWLFeatures(utils::BinaryReader &reader) : WLFeatures(reader) {}
+
     void IWLFeatures::refine(const std::shared_ptr<graph_generator::Graph> &graph,
                              std::vector<int> &colours,
                              int iteration) {
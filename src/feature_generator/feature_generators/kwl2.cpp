@@ -1,9 +1,14 @@
 #include "../../../include/feature_generator/feature_generators/kwl2.hpp"
 
 #include "../../../include/graph_generator/graph_generator_factory.hpp"
+#include "../../../include/utils/exceptions.hpp"
 #include "../../../include/utils/nlohmann/json.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <numeric>
+#include <random>
 #include <sstream>
 
 using json = nlohmann::json;
@@ -30,7 +35,24 @@ namespace wlplan {
     KWL2Features::KWL2Features(const std::string &filename, bool quiet)
         : Features(filename, quiet) {}
 
-    int KWL2Features::get_n_features() const { return get_n_colours(); }
+    KWL2Features::KWL2Features(utils::BinaryReader &reader) : Features(reader) {}
+
+    long KWL2Features::get_n_features() const { return get_n_colours(); }
+
+    void KWL2Features::set_sampling(long budget, int seed) {
+      if (feature_name != "2-kwl") {
+        throw NotSupportedError("Sampling for feature option `" + feature_name + "`");
+      }
+      if (budget < 0) {
+        throw std::runtime_error("Sampling budget must be non-negative, got " +
+                                 std::to_string(budget));
+      }
+      if (collected) {
+        throw std::runtime_error("Sampling must be set before collect() as it changes the colours");
+      }
+      sample_budget = budget;
+      sample_seed = seed;
+    }
 
     int kwl2_pair_to_index_map(int n, int i, int j) {
       // map pair where 0 <= i, j < n to vec index
@@ -39,14 +61,41 @@ namespace wlplan {
 
     int get_n_kwl2_pairs(int n_nodes) { return static_cast<int>(n_nodes * n_nodes); }
 
-    void KWL2Features::refine(const std::shared_ptr<graph_generator::Graph> &graph,
-                              std::vector<int> &colours,
-                              int iteration) {
+    std::vector<int> KWL2Features::get_sampled_nodes(int n_nodes) const {
+      std::vector<int> nodes(n_nodes);
+      std::iota(nodes.begin(), nodes.end(), 0);
+      if (sample_budget <= 0) {
+        return nodes;
+      }
+
+      // each iteration costs n^3 pair-witness evaluations
+      long n_sampled = std::cbrt((double)sample_budget / std::max(iterations, 1));
+      n_sampled = std::max(n_sampled, 1L);
+      while ((n_sampled + 1) * (n_sampled + 1) * (n_sampled + 1) * std::max(iterations, 1) <=
+             sample_budget) {
+        n_sampled++;  // fix floating point rounding of cbrt
+      }
+      if (n_sampled >= n_nodes) {
+        return nodes;
+      }
+
+      // partial Fisher-Yates shuffle; the generator is seeded from the graph size and modulo is
+      // used over std::uniform_int_distribution so that samples are identical across platforms
+      std::mt19937_64 rng((uint64_t)sample_seed * 0x9e3779b97f4a7c15ULL + n_nodes);
+      for (int i = 0; i < n_sampled; i++) {
+        int j = i + (int)(rng() % (uint64_t)(n_nodes - i));
+        std::swap(nodes[i], nodes[j]);
+      }
+      nodes.resize(n_sampled);
+      std::sort(nodes.begin(), nodes.end());
+      return nodes;
+    }
+
+    void KWL2Features::refine(int n_nodes, std::vector<int> &colours, int iteration) {
       // memory for storing string and hashed int representation of colours
       std::vector<int> new_colour;
       std::vector<int> neighbour_vector;
       int new_colour_compressed, pair1, pair2, pair1_col, pair2_col;
-      int n_nodes = graph->nodes.size();
 
       std::vector<int> new_colours(colours.size(), UNSEEN_COLOUR);
 
@@ -90,14 +139,23 @@ namespace wlplan {
       colours = new_colours;
     }
 
-    std::vector<int> get_kwl2_pair_to_edge_label(std::shared_ptr<graph_generator::Graph> graph) {
-      int n_nodes = graph->nodes.size();
+    std::vector<int> get_kwl2_pair_to_edge_label(std::shared_ptr<graph_generator::Graph> graph,
+                                                 const std::vector<int> &nodes) {
+      int n_nodes = nodes.size();
       int n_pairs = get_n_kwl2_pairs(n_nodes);
+      std::vector<int> node_to_index(graph->nodes.size(), -1);
+      for (int i = 0; i < n_nodes; i++) {
+        node_to_index[nodes[i]] = i;
+      }
       std::vector<int> pair_to_edge_label(n_pairs, NO_EDGE_COLOUR);
-      for (int u = 0; u < n_nodes; u++) {
-        for (const auto &[edge_label, v] : graph->edges[u]) {
-          pair_to_edge_label[kwl2_pair_to_index_map(n_nodes, u, v)] = edge_label;
-          pair_to_edge_label[kwl2_pair_to_index_map(n_nodes, v, u)] = edge_label;
+      for (int i = 0; i < n_nodes; i++) {
+        for (const auto &[edge_label, v] : graph->edges[nodes[i]]) {
+          int j = node_to_index[v];
+          if (j == -1) {
+            continue;
+          }
+          pair_to_edge_label[kwl2_pair_to_index_map(n_nodes, i, j)] = edge_label;
+          pair_to_edge_label[kwl2_pair_to_index_map(n_nodes, j, i)] = edge_label;
         }
       }
       return pair_to_edge_label;
@@ -115,34 +173,36 @@ namespace wlplan {
       return col;
     }
 
+    std::vector<int>
+    KWL2Features::get_initial_colours(const std::shared_ptr<graph_generator::Graph> &graph,
+                                      const std::vector<int> &nodes) {
+      int n_nodes = nodes.size();
+      std::vector<int> colours(get_n_kwl2_pairs(n_nodes));
+      std::vector<int> pair_to_edge_label = get_kwl2_pair_to_edge_label(graph, nodes);
+      for (int i = 0; i < n_nodes; i++) {
+        for (int j = 0; j < n_nodes; j++) {
+          int index = kwl2_pair_to_index_map(n_nodes, i, j);
+          colours[index] = get_initial_colour(index, nodes[i], nodes[j], graph, pair_to_edge_label);
+        }
+      }
+      return colours;
+    }
+
     void KWL2Features::collect_impl(const std::vector<graph_generator::Graph> &graphs) {
       // intermediate graph colours during WL
       std::vector<int> colours;
 
       for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
         const auto graph = std::make_shared<graph_generator::Graph>(graphs[graph_i]);
-        auto edges = graph->edges;
-        int n_nodes = graph->nodes.size();
-
-        int n_pairs = get_n_kwl2_pairs(n_nodes);
-
-        // intermediate colours
-        colours = std::vector<int>(n_pairs, 0);
-
-        std::vector<int> pair_to_edge_label = get_kwl2_pair_to_edge_label(graph);
+        std::vector<int> nodes = get_sampled_nodes(graph->nodes.size());
+        int n_nodes = nodes.size();
 
         // init colours
-        for (int u = 0; u < n_nodes; u++) {
-          for (int v = 0; v < n_nodes; v++) {
-            int index = kwl2_pair_to_index_map(n_nodes, u, v);
-            int col = get_initial_colour(index, u, v, graph, pair_to_edge_label);
-            colours[index] = col;
-          }
-        }
+        colours = get_initial_colours(graph, nodes);
 
         // main WL loop
         for (int iteration = 1; iteration < iterations + 1; iteration++) {
-          refine(graph, colours, iteration);
+          refine(n_nodes, colours, iteration);
         }
       }
     }
@@ -151,28 +211,33 @@ namespace wlplan {
       /* 1. Initialise embedding before pruning */
       Embedding x0(get_n_colours(), 0);
 
-      int n_nodes = graph->nodes.size();
-      int n_pairs = get_n_kwl2_pairs(n_nodes);
-      std::vector<int> colours(n_pairs);
-
-      std::vector<int> pair_to_edge_label = get_kwl2_pair_to_edge_label(graph);
+      std::vector<int> nodes = get_sampled_nodes(graph->nodes.size());
+      int n_nodes = nodes.size();
+
+      // Nodes are sampled without replacement, so a pair (u, u) is kept with probability n / N
+      // and a pair (u, v) with u != v with probability n(n - 1) / (N(N - 1)). Counts are
+      // weighted by the inverse probabilities to be unbiased.
+      double n = n_nodes;
+      double N = graph->nodes.size();
+      double diagonal_weight = n > 0 ? N / n : 1.0;
+      double pair_weight = n > 1 ? (N * (N - 1)) / (n * (n - 1)) : 1.0;
+      auto add_colours = [&](const std::vector<int> &colours, int itr) {
+        for (int i = 0; i < n_nodes; i++) {
+          for (int j = 0; j < n_nodes; j++) {
+            int col = colours[kwl2_pair_to_index_map(n_nodes, i, j)];
+            add_colour_to_x(col, itr, x0, i == j ? diagonal_weight : pair_weight);
+          }
+        }
+      };
 
       /* 2. Compute initial colours */
-      for (int u = 0; u < n_nodes; u++) {
-        for (int v = 0; v < n_nodes; v++) {
-          int index = kwl2_pair_to_index_map(n_nodes, u, v);
-          int col = get_initial_colour(index, u, v, graph, pair_to_edge_label);
-          colours[index] = col;
-          add_colour_to_x(col, 0, x0);
-        }
-      }
+      std::vector<int> colours = get_initial_colours(graph, nodes);
+      add_colours(colours, 0);
 
       /* 3. Main WL loop */
       for (int itr = 1; itr < iterations + 1; itr++) {
-        refine(graph, colours, itr);
-        for (const int col : colours) {
-          add_colour_to_x(col, itr, x0);
-        }
+        refine(n_nodes, colours, itr);
+        add_colours(colours, itr);
       }
 
       return x0;
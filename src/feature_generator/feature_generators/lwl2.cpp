@@ -23,6 +23,8 @@ namespace wlplan {
     LWL2Features::LWL2Features(const std::string &filename, bool quiet)
         : KWL2Features(filename, quiet) {}
 
+    LWL2Features::LWL2Features(utils::BinaryReader &reader) : KWL2Features(reader) {}
+
     int lwl2_pair_to_index_map(int n, int i, int j) {
       // map pair where 0 <= i < j < n to vec index
       return j - i - 1 + (i * n) - (i * (i + 1)) / 2;
@@ -136,7 +138,46 @@ namespace wlplan {
       return col;
     }
 
+    template <typename OnColour>
+    void LWL2Features::refine_graph(const std::shared_ptr<graph_generator::Graph> &graph,
+                                    OnColour on_colour) {
+      int n_nodes = graph->nodes.size();
+      int n_pairs = get_n_lwl2_pairs(n_nodes);
+      std::vector<int> colours(n_pairs);
+
+      std::vector<int> pair_to_edge_label = get_lwl2_pair_to_edge_label(graph);
+      std::vector<std::set<int>> pair_to_neighbours = get_lwl2_pair_to_neighbours(graph);
+
+      /* 1. Compute initial colours */
+      for (int u = 0; u < n_nodes; u++) {
+        for (int v = u + 1; v < n_nodes; v++) {
+          int index = lwl2_pair_to_index_map(n_nodes, u, v);
+          int col = get_initial_colour(index, u, v, graph, pair_to_edge_label);
+          colours[index] = col;
+          on_colour(0, col);
+        }
+      }
+
+      /* 2. Main WL loop */
+      for (int itr = 1; itr < iterations + 1; itr++) {
+        refine(graph, pair_to_neighbours, colours, itr);
+        for (const int col : colours) {
+          on_colour(itr, col);
+        }
+      }
+    }
+
     void LWL2Features::collect_impl(const std::vector<graph_generator::Graph> &graphs) {
+      if (pruning == PruningOptions::NONE) {
+        // Without pruning, graphs are refined independently, so each graph goes through all
+        // iterations before the next one and only the colours of one graph are kept in memory.
+        for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
+          const auto graph = std::make_shared<graph_generator::Graph>(graphs[graph_i]);
+          refine_graph(graph, [](int, int) {});
+        }
+        return;
+      }
+
       // intermediate graph colours during WL
       std::vector<std::vector<int>> graph_colours;
 
@@ -150,7 +191,6 @@ namespace wlplan {
         std::vector<int> colours(n_pairs, 0);
 
         std::vector<int> pair_to_edge_label = get_lwl2_pair_to_edge_label(graph);
-        std::vector<std::set<int>> pair_to_neighbours = get_lwl2_pair_to_neighbours(graph);
 
         // init colours
         for (int u = 0; u < n_nodes; u++) {
@@ -164,7 +204,9 @@ namespace wlplan {
         graph_colours.push_back(colours);
       }
 
-      // main WL loop
+      init_layer_pruning(graph_colours);
+
+      // main WL loop, layer by layer as pruning needs the colours of all graphs
       for (int itr = 1; itr < iterations + 1; itr++) {
         log_iteration(itr);
         for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
@@ -174,7 +216,7 @@ namespace wlplan {
         }
 
         // layer pruning
-        prune_this_iteration(itr, graphs, graph_colours);
+        prune_this_iteration(itr, graph_colours);
       }
     }
 
@@ -231,30 +273,8 @@ namespace wlplan {
       /* 1. Initialise embedding before pruning */
       Embedding x0(get_n_colours(), 0);
 
-      int n_nodes = graph->nodes.size();
-      int n_pairs = get_n_lwl2_pairs(n_nodes);
-      std::vector<int> colours(n_pairs);
-
-      std::vector<int> pair_to_edge_label = get_lwl2_pair_to_edge_label(graph);
-      std::vector<std::set<int>> pair_to_neighbours = get_lwl2_pair_to_neighbours(graph);
-
-      /* 2. Compute initial colours */
-      for (int u = 0; u < n_nodes; u++) {
-        for (int v = u + 1; v < n_nodes; v++) {
-          int index = lwl2_pair_to_index_map(n_nodes, u, v);
-          int col = get_initial_colour(index, u, v, graph, pair_to_edge_label);
-          colours[index] = col;
-          add_colour_to_x(col, 0, x0);
-        }
-      }
-
-      /* 3. Main WL loop */
-      for (int itr = 1; itr < iterations + 1; itr++) {
-        refine(graph, pair_to_neighbours, colours, itr);
-        for (const int col : colours) {
-          add_colour_to_x(col, itr, x0);
-        }
-      }
+      /* 2. Refine and count colours */
+      refine_graph(graph, [&](int itr, int col) { add_colour_to_x(col, itr, x0); });
 
       return x0;
     }
@@ -22,6 +22,8 @@ namespace wlplan {
     NIWLFeatures::NIWLFeatures(const std::string &filename, bool quiet)
         : IWLFeatures(filename, quiet) {}
 
+    NIWLFeatures::NIWLFeatures(utils::BinaryReader &reader) : IWLFeatures(reader) {}
+
     Embedding NIWLFeatures::embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
       Embedding iwl_embedding = IWLFeatures::embed_impl(graph);
       double n = (double)graph->get_n_nodes();
@@ -2,12 +2,17 @@
 
 #include "../../../include/graph_generator/graph_generator_factory.hpp"
 #include "../../../include/utils/exceptions.hpp"
+#include "../../../include/utils/hashing.hpp"
 #include "../../../include/utils/nlohmann/json.hpp"
 
+#include <algorithm>
 #include <fstream>
+#include <iostream>
 #include <queue>
 #include <set>
 #include <sstream>
+#include <tuple>
+#include <unordered_set>
 
 using json = nlohmann::json;
 
@@ -28,63 +33,357 @@ namespace wlplan {
                            bool multiset_hash)
         : Features("wl", domain, graph_representation, iterations, pruning, multiset_hash) {}
 
-    WLFeatures::WLFeatures(const std::string &filename) : Features(filename) {}
+    WLFeatures::WLFeatures(const std::string &filename) : Features(filename) {
+      set_refinement(refinement);
+    }
+
+    WLFeatures::WLFeatures(const std::string &filename, bool quiet) : Features(filename, quiet) {
+      set_refinement(refinement);
+    }
+
+    WLFeatures::WLFeatures(utils::BinaryReader &reader) : Features(reader) {
+      set_refinement(reader.read_string());
+    }
+
+    long WLFeatures::get_n_features() const { return get_n_colours(); }
+
+    void WLFeatures::set_refinement(const std::string &refinement) {
+      std::vector<std::string> options = RefinementOptions::get_all();
+      if (std::find(options.begin(), options.end(), refinement) == options.end()) {
+        throw std::runtime_error("Unknown refinement option `" + refinement + "`");
+      }
+      this->refinement = refinement;
+    }
+
+    void WLFeatures::write(utils::BinaryWriter &writer) const {
+      Features::write(writer);
+      writer.write_string(refinement);
+    }
+
+    void WLFeatures::set_signature_hash(bool signature_hash) {
+      if (signature_hash && !multiset_hash) {
+        throw NotSupportedError("Signature hashing with set hashing, as signatures are sums");
+      }
+      if (signature_hash && pruning != PruningOptions::NONE) {
+        throw NotSupportedError("Signature hashing with pruning option `" + pruning + "`");
+      }
+      if (collected) {
+        throw std::runtime_error(
+            "Signature hashing must be set before collect() as it changes the colours");
+      }
+      this->signature_hash = signature_hash;
+    }
+
+    template <typename ColourOf>
+    bool WLFeatures::set_signature_key(const std::shared_ptr<graph_generator::Graph> &graph,
+                                       int u,
+                                       ColourOf colour_of) {
+      int current_colour = colour_of(u);
+      if (current_colour == UNSEEN_COLOUR) {
+        return false;
+      }
+      uint64_t signature = utils::mix_pair(current_colour, SIGNATURE_SELF_LABEL);
+      for (const auto &edge : graph->edges[u]) {
+        int neighbour_colour = colour_of(edge.second);
+        if (neighbour_colour == UNSEEN_COLOUR) {
+          return false;
+        }
+        // commutative so that the neighbour order does not matter
+        signature += utils::mix_pair(neighbour_colour, edge.first);
+      }
+      utils::to_int_pair(signature, signature_key);
+      return true;
+    }
+
+    void WLFeatures::check_signature_collision(const std::vector<int> &sorted_key, int iteration) {
+      if ((int)signature_to_key.size() < iterations + 1) {
+        signature_to_key.resize(iterations + 1);
+      }
+      auto [it, inserted] = signature_to_key[iteration].try_emplace(signature_key, sorted_key);
+      if (!inserted && it->second != sorted_key) {
+        std::cout << "ERROR: signature collision at iteration " << iteration << " between ";
+        debug_vec(it->second);
+        std::cout << "and ";
+        debug_vec(sorted_key);
+      }
+    }
+
+    template <typename ColourOf>
+    int WLFeatures::get_refined_colour(const std::shared_ptr<graph_generator::Graph> &graph,
+                                       int u,
+                                       ColourOf colour_of,
+                                       int iteration) {
+      if (signature_hash) {
+        if (!set_signature_key(graph, u, colour_of)) {
+          return UNSEEN_COLOUR;
+        }
+#ifndef DEBUGMODE
+        return get_colour_hash(signature_key, iteration);
+#endif
+      }
+
+      // skip unseen colours
+      int current_colour = colour_of(u);
+      if (current_colour == UNSEEN_COLOUR) {
+        return UNSEEN_COLOUR;
+      }
+      neighbour_container->clear();
+
+      for (const auto &edge : graph->edges[u]) {
+        // skip unseen colours
+        int neighbour_colour = colour_of(edge.second);
+        if (neighbour_colour == UNSEEN_COLOUR) {
+          return UNSEEN_COLOUR;
+        }
+
+        // add sorted neighbour (colour, edge_label) pair
+        neighbour_container->insert(neighbour_colour, edge.first);
+      }
 
-    WLFeatures::WLFeatures(const std::string &filename, bool quiet) : Features(filename, quiet) {}
+      // add current colour and sorted neighbours into sorted colour key
+      std::vector<int> new_colour = neighbour_container->to_vector();
+      new_colour.push_back(current_colour);
 
-    int WLFeatures::get_n_features() const { return get_n_colours(); }
+#ifdef DEBUGMODE
+      if (signature_hash) {
+        check_signature_collision(new_colour, iteration);
+        return get_colour_hash(signature_key, iteration);
+      }
+#endif
+
+      // hash seen colours
+      return get_colour_hash(new_colour, iteration);
+    }
 
     void WLFeatures::refine(const std::shared_ptr<graph_generator::Graph> &graph,
                             std::set<int> &nodes,
                             std::vector<int> &colours,
                             int iteration) {
-      // memory for storing string and hashed int representation of colours
-      std::vector<int> new_colour;
-      int new_colour_compressed;
-
       std::vector<int> new_colours(colours.size(), UNSEEN_COLOUR);
       std::vector<int> nodes_to_discard;
+      auto colour_of = [&colours](int v) { return colours[v]; };
 
       for (const int u : nodes) {
-        // skip unseen colours
-        int current_colour = colours[u];
-        if (current_colour == UNSEEN_COLOUR) {
-          new_colour_compressed = UNSEEN_COLOUR;
+        new_colours[u] = get_refined_colour(graph, u, colour_of, iteration);
+        if (new_colours[u] == UNSEEN_COLOUR) {
           nodes_to_discard.push_back(u);
-          goto end_of_iteration;
         }
-        neighbour_container->clear();
+      }
+
+      // discard nodes
+      for (const int u : nodes_to_discard) {
+        nodes.erase(u);
+      }
 
+      colours = std::move(new_colours);
+    }
+
+    void WLFeatures::refine_stable(const std::shared_ptr<graph_generator::Graph> &graph,
+                                   std::vector<int> &colours,
+                                   int iteration) {
+      // representatives are visited in order of first occurrence, so new colours are created in
+      // the same order as in refine()
+      std::unordered_map<int, int> class_to_new_colour;
+      std::vector<int> new_colours(colours.size(), UNSEEN_COLOUR);
+      auto colour_of = [&colours](int v) { return colours[v]; };
+      for (size_t u = 0; u < colours.size(); u++) {
+        auto it = class_to_new_colour.find(colours[u]);
+        if (it != class_to_new_colour.end()) {
+          new_colours[u] = it->second;
+        } else {
+          new_colours[u] = get_refined_colour(graph, u, colour_of, iteration);
+          class_to_new_colour[colours[u]] = new_colours[u];
+        }
+      }
+      colours = std::move(new_colours);
+    }
+
+    template <typename OnClass>
+    void WLFeatures::refine_partition(const std::shared_ptr<graph_generator::Graph> &graph,
+                                      OnClass on_class) {
+      int n_nodes = graph->nodes.size();
+
+      // reversed edges, as the key of a node depends on the colours of its out-neighbours
+      std::vector<int> in_offsets(n_nodes + 1, 0);
+      for (int u = 0; u < n_nodes; u++) {
         for (const auto &edge : graph->edges[u]) {
-          // skip unseen colours
-          int neighbour_colour = colours[edge.second];
-          if (neighbour_colour == UNSEEN_COLOUR) {
-            new_colour_compressed = UNSEEN_COLOUR;
-            nodes_to_discard.push_back(u);
-            goto end_of_iteration;
+          in_offsets[edge.second + 1]++;
+        }
+      }
+      for (int v = 0; v < n_nodes; v++) {
+        in_offsets[v + 1] += in_offsets[v];
+      }
+      std::vector<int> in_nodes(in_offsets[n_nodes]);
+      std::vector<int> in_fill(in_offsets.begin(), in_offsets.end() - 1);
+      for (int u = 0; u < n_nodes; u++) {
+        for (const auto &edge : graph->edges[u]) {
+          in_nodes[in_fill[edge.second]++] = u;
+        }
+      }
+
+      // class c holds the nodes order[class_begin[c]], ..., order[class_end[c] - 1]
+      std::vector<int> order(n_nodes), position(n_nodes), node_class(n_nodes);
+      std::vector<int> class_begin, class_end, class_colour;
+      auto colour_of = [&](int v) { return class_colour[node_class[v]]; };
+
+      /* 1. Initial classes */
+      std::unordered_map<int, int> colour_to_class;
+      std::vector<int> class_size;
+      for (int u = 0; u < n_nodes; u++) {
+        int col = get_colour_hash({graph->nodes[u]}, 0);
+        auto [it, inserted] = colour_to_class.try_emplace(col, class_colour.size());
+        if (inserted) {
+          class_colour.push_back(col);
+          class_size.push_back(0);
+        }
+        node_class[u] = it->second;
+        class_size[it->second]++;
+      }
+      for (size_t c = 0; c < class_colour.size(); c++) {
+        int begin = c == 0 ? 0 : class_begin[c - 1] + class_size[c - 1];
+        class_begin.push_back(begin);
+        class_end.push_back(begin);
+      }
+      for (int u = 0; u < n_nodes; u++) {
+        int c = node_class[u];
+        position[u] = class_end[c]++;
+        order[position[u]] = u;
+      }
+      for (size_t c = 0; c < class_colour.size(); c++) {
+        on_class(0, class_colour[c], class_end[c] - class_begin[c]);
+      }
+
+      /* 2. Main WL loop */
+      std::vector<char> dirty(n_nodes, 1);
+      std::vector<int> dirty_nodes(order);
+      std::vector<int> new_colour(n_nodes);
+      std::vector<int> split_classes;
+      for (int itr = 1; itr < iterations + 1; itr++) {
+        int n_classes = class_colour.size();
+
+        // keys of dirty nodes and of one clean representative per class, with old colours
+        std::vector<int> n_dirty(n_classes, 0);
+        for (const int u : dirty_nodes) {
+          new_colour[u] = get_refined_colour(graph, u, colour_of, itr);
+          n_dirty[node_class[u]]++;
+        }
+        std::vector<int> rep_colour(n_classes, UNSEEN_COLOUR);
+        for (int c = 0; c < n_classes; c++) {
+          if (n_dirty[c] == class_end[c] - class_begin[c]) {
+            continue;
+          }
+          int i = class_begin[c];
+          while (dirty[order[i]]) {
+            i++;
           }
+          rep_colour[c] = get_refined_colour(graph, order[i], colour_of, itr);
+        }
 
-          // add sorted neighbour (colour, edge_label) pair
-          neighbour_container->insert(neighbour_colour, edge.first);
+        // clean nodes keep the representative colour of their class
+        for (int c = 0; c < n_classes; c++) {
+          if (n_dirty[c] < class_end[c] - class_begin[c]) {
+            class_colour[c] = rep_colour[c];
+          }
         }
 
-        // add current colour and sorted neighbours into sorted colour key
-        new_colour = neighbour_container->to_vector();
-        new_colour.push_back(current_colour);
+        // split off dirty nodes with a different colour from the rest of their class
+        std::sort(dirty_nodes.begin(), dirty_nodes.end(), [&](const int a, const int b) {
+          return std::make_tuple(node_class[a], new_colour[a], a) <
+                 std::make_tuple(node_class[b], new_colour[b], b);
+        });
+        split_classes.clear();
+        size_t i = 0;
+        while (i < dirty_nodes.size()) {
+          int c = node_class[dirty_nodes[i]];
+          size_t j = i;
+          while (j < dirty_nodes.size() && node_class[dirty_nodes[j]] == c) {
+            j++;
+          }
 
-        // hash seen colours
-        new_colour_compressed = get_colour_hash(new_colour, iteration);
+          // without clean nodes, the largest group stays in the class
+          int kept_colour = rep_colour[c];
+          if (n_dirty[c] == class_end[c] - class_begin[c]) {
+            size_t kept_size = 0;
+            for (size_t k = i, l = i; k < j; k = l) {
+              while (l < j && new_colour[dirty_nodes[l]] == new_colour[dirty_nodes[k]]) {
+                l++;
+              }
+              if (l - k > kept_size) {
+                kept_size = l - k;
+                kept_colour = new_colour[dirty_nodes[k]];
+              }
+            }
+            class_colour[c] = kept_colour;
+          }
 
-      end_of_iteration:
-        new_colours[u] = new_colour_compressed;
-      }
+          for (size_t k = i, l = i; k < j; k = l) {
+            int col = new_colour[dirty_nodes[k]];
+            while (l < j && new_colour[dirty_nodes[l]] == col) {
+              l++;
+            }
+            if (col == kept_colour) {
+              continue;
+            }
+            // move nodes to the back of class c and make them a new class
+            int new_class = class_colour.size();
+            class_colour.push_back(col);
+            class_end.push_back(class_end[c]);
+            for (size_t m = k; m < l; m++) {
+              int x = dirty_nodes[m];
+              int last = --class_end[c];
+              int y = order[last];
+              std::swap(order[position[x]], order[last]);
+              position[y] = position[x];
+              position[x] = last;
+              node_class[x] = new_class;
+            }
+            class_begin.push_back(class_end[c]);
+            split_classes.push_back(new_class);
+          }
+          i = j;
+        }
 
-      // discard nodes
-      for (const int u : nodes_to_discard) {
-        nodes.erase(u);
+        for (size_t c = 0; c < class_colour.size(); c++) {
+          on_class(itr, class_colour[c], class_end[c] - class_begin[c]);
+        }
+
+        // nodes whose keys may differ from the rest of their class in the next iteration
+        if (itr == iterations) {
+          break;
+        }
+        for (const int u : dirty_nodes) {
+          dirty[u] = 0;
+        }
+        dirty_nodes.clear();
+        for (const int c : split_classes) {
+          for (int p = class_begin[c]; p < class_end[c]; p++) {
+            int x = order[p];
+            if (!dirty[x]) {
+              dirty[x] = 1;
+              dirty_nodes.push_back(x);
+            }
+            for (int q = in_offsets[x]; q < in_offsets[x + 1]; q++) {
+              int w = in_nodes[q];
+              if (!dirty[w]) {
+                dirty[w] = 1;
+                dirty_nodes.push_back(w);
+              }
+            }
+          }
+        }
       }
+    }
 
-      colours = std::move(new_colours);
+    // number of colour classes, or -1 if a node is unseen as the partition may then be coarsened
+    int count_colour_classes(const std::vector<int> &colours) {
+      std::unordered_set<int> classes;
+      for (const int col : colours) {
+        if (col == UNSEEN_COLOUR) {
+          return -1;
+        }
+        classes.insert(col);
+      }
+      return classes.size();
     }
 
     void WLFeatures::refine_fast(const std::shared_ptr<graph_generator::Graph> &graph,
@@ -94,6 +393,16 @@ namespace wlplan {
       std::vector<int> new_colour;
       std::vector<int> new_colours(colours.size(), UNSEEN_COLOUR);
 
+      if (signature_hash) {
+        auto colour_of = [&colours](int v) { return colours[v]; };
+        for (size_t u = 0; u < colours.size(); u++) {
+          set_signature_key(graph, u, colour_of);
+          new_colours[u] = get_colour_hash_fast(signature_key, iteration);
+        }
+        colours = std::move(new_colours);
+        return;
+      }
+
       for (size_t u = 0; u < colours.size(); u++) {
         neighbour_container->clear_init(graph->edges[u].size());
 
@@ -113,7 +422,58 @@ namespace wlplan {
       colours = std::move(new_colours);
     }
 
+    template <typename OnColour>
+    void WLFeatures::refine_graph(const std::shared_ptr<graph_generator::Graph> &graph,
+                                  OnColour on_colour) {
+      int n_nodes = graph->nodes.size();
+      std::vector<int> colours(n_nodes);
+      std::set<int> nodes = graph->get_nodes_set();
+
+      /* 1. Compute initial colours */
+      for (const int node_i : nodes) {
+        int col = get_colour_hash({graph->nodes[node_i]}, 0);
+        colours[node_i] = col;
+        on_colour(0, col);
+      }
+
+      /* 2. Main WL loop */
+      // the partition cannot be coarsened while there are no unseen colours, so an equal number
+      // of classes after refinement means that it is stable
+      int n_classes = count_colour_classes(colours);
+      bool stable = false;
+      for (int itr = 1; itr < iterations + 1; itr++) {
+        if (stable) {
+          refine_stable(graph, colours, itr);
+        } else {
+          refine(graph, nodes, colours, itr);
+          if (itr < iterations) {
+            int new_n_classes = count_colour_classes(colours);
+            stable = new_n_classes != -1 && new_n_classes == n_classes;
+            n_classes = new_n_classes;
+          }
+        }
+        for (const int col : colours) {
+          on_colour(itr, col);
+        }
+      }
+    }
+
     void WLFeatures::collect_impl(const std::vector<graph_generator::Graph> &graphs) {
+      if (pruning == PruningOptions::NONE) {
+        // Without pruning, graphs are refined independently, so each graph goes through all
+        // iterations before the next one and only the colours of one graph are kept in memory.
+        // Colours of different layers are created interleaved, but keys are the same.
+        for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
+          const auto graph = std::make_shared<graph_generator::Graph>(graphs[graph_i]);
+          if (refinement == RefinementOptions::PARTITION) {
+            refine_partition(graph, [](int, int, int) {});
+          } else {
+            refine_graph(graph, [](int, int) {});
+          }
+        }
+        return;
+      }
+
       // Intermediate graph colours during WL
       // It could be more optimal to use map<int, int> for graph colours, with UNSEEN_COLOUR
       // nodes not showing up in the map. However, this would make the code more complex.
@@ -133,7 +493,9 @@ namespace wlplan {
         graph_colours.push_back(colours);
       }
 
-      // main WL loop
+      init_layer_pruning(graph_colours);
+
+      // main WL loop, layer by layer as pruning needs the colours of all graphs
       for (int itr = 1; itr < iterations + 1; itr++) {
         log_iteration(itr);
         for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
@@ -143,7 +505,7 @@ namespace wlplan {
         }
 
         // layer pruning
-        prune_this_iteration(itr, graphs, graph_colours);
+        prune_this_iteration(itr, graph_colours);
       }
     }
 
@@ -191,24 +553,19 @@ namespace wlplan {
     Embedding WLFeatures::embed_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
       /* 1. Initialise embedding before pruning, and set up memory */
       Embedding x0(get_n_colours(), 0);
-      int n_nodes = graph->nodes.size();
-      std::vector<int> colours(n_nodes);
-      std::set<int> nodes = graph->get_nodes_set();
-
-      /* 2. Compute initial colours */
-      for (const int node_i : nodes) {
-        int col = get_colour_hash({graph->nodes[node_i]}, 0);
-        colours[node_i] = col;
-        add_colour_to_x(col, 0, x0);
+      if (refinement == RefinementOptions::PARTITION) {
+        refine_partition(graph, [&](int itr, int col, int class_size) {
+          bool is_seen_colour = (col != UNSEEN_COLOUR);
+          seen_colour_statistics[is_seen_colour][itr] += class_size;
+          if (is_seen_colour) {
+            add_to_feature(col, class_size, x0);
+          }
+        });
+        return x0;
       }
 
-      /* 3. Main WL loop */
-      for (int itr = 1; itr < iterations + 1; itr++) {
-        refine(graph, nodes, colours, itr);
-        for (const int col : colours) {
-          add_colour_to_x(col, itr, x0);
-        }
-      }
+      /* 2. Refine and count colours */
+      refine_graph(graph, [&](int itr, int col) { add_colour_to_x(col, itr, x0); });
 
       return x0;
     }
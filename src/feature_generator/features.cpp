@@ -6,13 +6,19 @@
 #include "../../include/feature_generator/neighbour_containers/wl_neighbour_container.hpp"
 #include "../../include/feature_generator/neighbour_containers/wl_neighbour_container_mk2.hpp"
 #include "../../include/graph_generator/graph_generator_factory.hpp"
+#include "../../include/graph_generator/graph_stream.hpp"
+#include "../../include/planning/binary_format.hpp"
 #include "../../include/utils/exceptions.hpp"
 #include "../../include/utils/nlohmann/json.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <numeric>
 #include <sstream>
 #include <string>
 #include <thread>
@@ -21,6 +27,23 @@ using json = nlohmann::json;
 
 namespace wlplan {
   namespace feature_generator {
+    namespace {
+      std::string strip_quotes(std::string version) {
+        version.erase(std::remove(version.begin(), version.end(), '"'), version.end());
+        return version;
+      }
+
+      void check_package_version(const std::string &package_version) {
+        // versions are quoted when WLPLAN_VERSION is defined as a string, as by CMake
+        std::string cur_pkg_ver = strip_quotes(MACRO_STRINGIFY(WLPLAN_VERSION));
+        if (strip_quotes(package_version) != cur_pkg_ver) {
+          std::cout << "WARNING: loaded generator was created with version " << package_version
+                    << " but current version is " << cur_pkg_ver << ". ";
+          std::cout << "This may lead to unexpected behaviour." << std::endl;
+        }
+      }
+    }  // namespace
+
     Features::Features(const std::string feature_name,
                        const planning::Domain &domain,
                        std::string graph_representation,
@@ -32,7 +55,14 @@ namespace wlplan {
           graph_representation(graph_representation),
           iterations(iterations),
           pruning(pruning),
-          multiset_hash(multiset_hash) {
+          multiset_hash(multiset_hash),
+          sample_budget(0),
+          sample_seed(0),
+          signature_hash(false),
+          refinement(RefinementOptions::NODE),
+          hash_dim(0),
+          frequency_threshold(DEFAULT_FREQUENCY_THRESHOLD),
+          frequency_sketch_width(0) {
       quiet = false;
       check_valid_configuration();
 
@@ -41,6 +71,7 @@ namespace wlplan {
       collected = false;
       collecting = false;
       pruned = false;
+      greedy_maxsat = false;
       store_weights = false;
 
       colour_hash = new_colour_hash();
@@ -59,14 +90,15 @@ namespace wlplan {
     }
 
     void Features::initialise_variables() {
-      graph_generator = graph_generator::init_feature_generator(graph_representation, *domain);
+      graph_generator = graph_generator::init_feature_generator(graph_representation, domain);
       seen_colour_statistics =
           std::vector<std::vector<long>>(2, std::vector<long>(iterations + 1, 0));
 
       // We use a factory style method here instead of a virtual function as this is called
       // from a constructor, from which virtual functions are not allowed to be called.
       if (std::set<std::string>({"wl", "ccwl", "ccwl-a", "iwl", "niwl"}).count(feature_name)) {
-        if (graph_representation == "custom")
+        // hashed colours span all ints and would overflow the packed keys of Mk2
+        if (graph_representation == "custom" || hash_dim > 0)
           neighbour_container = std::make_shared<WLNeighbourContainer>(multiset_hash);
         else
           neighbour_container = std::make_shared<WLNeighbourContainerMk2>(
@@ -80,6 +112,49 @@ namespace wlplan {
       }
     }
 
+    void Features::set_hash_dim(long hash_dim) {
+      if (!std::set<std::string>({"wl", "ccwl", "2-lwl", "2-kwl"}).count(feature_name)) {
+        throw NotSupportedError("Feature hashing for feature option `" + feature_name + "`");
+      }
+      if (pruning != PruningOptions::NONE) {
+        throw NotSupportedError("Feature hashing with pruning option `" + pruning + "`");
+      }
+      if (hash_dim < 0 || hash_dim > std::numeric_limits<int>::max() / 2) {
+        throw std::runtime_error("Hash dimension must be in [0, " +
+                                 std::to_string(std::numeric_limits<int>::max() / 2) + "], got " +
+                                 std::to_string(hash_dim));
+      }
+      if (collected && this->hash_dim == 0) {
+        throw std::runtime_error("Feature hashing must be set before collect()");
+      }
+      this->hash_dim = hash_dim;
+      collected = hash_dim > 0;
+      weights.clear();
+      sparse_weights.clear();
+      store_weights = false;
+      initialise_variables();
+    }
+
+    void Features::set_frequency_pruning(double threshold, long sketch_width) {
+      if (pruning != PruningOptions::LAYER_FREQUENCY &&
+          pruning != PruningOptions::LAYER_MAXSAT_FREQUENCY) {
+        throw NotSupportedError("Frequency pruning settings with pruning option `" + pruning + "`");
+      }
+      if (threshold < 0 || threshold > 1) {
+        throw std::runtime_error("Frequency threshold must be in [0, 1], got " +
+                                 std::to_string(threshold));
+      }
+      if (sketch_width < 0) {
+        throw std::runtime_error("Sketch width must be non-negative, got " +
+                                 std::to_string(sketch_width));
+      }
+      if (collected) {
+        throw std::runtime_error("Frequency pruning must be set before collect()");
+      }
+      frequency_threshold = threshold;
+      frequency_sketch_width = sketch_width;
+    }
+
     std::vector<std::set<int>> Features::new_layer_to_colours() const {
       return std::vector<std::set<int>>(iterations + 1, std::set<int>());
     }
@@ -99,22 +174,25 @@ namespace wlplan {
       std::ifstream i(filename);
       json j;
       i >> j;
-      std::string cur_pkg_ver = MACRO_STRINGIFY(WLPLAN_VERSION);
-      cur_pkg_ver.erase(std::remove(cur_pkg_ver.begin(), cur_pkg_ver.end(), '\"'),
-                        cur_pkg_ver.end());
 
       // load configurations
       package_version = j["package_version"];
-      if (package_version != cur_pkg_ver) {
-        std::cout << "WARNING: loaded generator was created with version " << package_version
-                  << " but current version is " << cur_pkg_ver << ". ";
-        std::cout << "This may lead to unexpected behaviour." << std::endl;
-      }
+      check_package_version(package_version);
       feature_name = j.at("feature_name").get<std::string>();
       graph_representation = j.at("graph_representation").get<std::string>();
       iterations = j.at("iterations").get<int>();
       pruning = j.at("pruning").get<std::string>();
       multiset_hash = j.at("multiset_hash").get<bool>();
+      sample_budget = j.value("sample_budget", 0L);
+      sample_seed = j.value("sample_seed", 0);
+      if (j.contains("selected_pairs")) {
+        selected_pairs = j.at("selected_pairs").get<std::vector<std::pair<int, int>>>();
+      }
+      signature_hash = j.value("signature_hash", false);
+      refinement = j.value("refinement", RefinementOptions::NODE);
+      hash_dim = j.value("hash_dim", 0L);
+      frequency_threshold = j.value("frequency_threshold", DEFAULT_FREQUENCY_THRESHOLD);
+      frequency_sketch_width = j.value("frequency_sketch_width", 0L);
 
       // load colours
       StrColourHash colour_hash_str = j.at("colour_hash").get<StrColourHash>();
@@ -157,6 +235,12 @@ namespace wlplan {
       if (weights_tmp.size() > 0) {
         store_weights = true;
         weights = weights_tmp;
+      } else if (j.contains("sparse_weights")) {
+        store_weights = true;
+        for (const auto &[index, weight] :
+             j.at("sparse_weights").get<std::vector<std::pair<long, double>>>()) {
+          sparse_weights[index] = weight;
+        }
       } else {
         store_weights = false;
       }
@@ -168,6 +252,7 @@ namespace wlplan {
       collected = true;
       collecting = false;
       pruned = true;
+      greedy_maxsat = false;
 
       initialise_variables();
 
@@ -178,9 +263,105 @@ namespace wlplan {
         std::cout << "iterations=" << iterations << std::endl;
         std::cout << "pruning=" << pruning << std::endl;
         std::cout << "multiset_hash=" << multiset_hash << std::endl;
+        if (sample_budget > 0) {
+          std::cout << "sample_budget=" << sample_budget << std::endl;
+          std::cout << "sample_seed=" << sample_seed << std::endl;
+        }
+        if (signature_hash) {
+          std::cout << "signature_hash=" << signature_hash << std::endl;
+        }
+        if (hash_dim > 0) {
+          std::cout << "hash_dim=" << hash_dim << std::endl;
+        }
+        if (pruning == PruningOptions::LAYER_FREQUENCY ||
+            pruning == PruningOptions::LAYER_MAXSAT_FREQUENCY) {
+          std::cout << "frequency_threshold=" << frequency_threshold << std::endl;
+          std::cout << "frequency_sketch_width=" << frequency_sketch_width << std::endl;
+        }
         std::cout << "domain=" << domain->to_string() << std::endl;
-        std::cout << "weights_size=" << weights_tmp.size() << std::endl;
+        std::cout << "weights_size=" << weights_tmp.size() + sparse_weights.size() << std::endl;
+      }
+    }
+
+    Features::Features(utils::BinaryReader &reader) {
+      feature_name = reader.read_string();
+      package_version = reader.read_string();
+      check_package_version(package_version);
+      graph_representation = reader.read_string();
+      iterations = reader.read<int32_t>();
+      if (iterations < 0) {
+        throw std::runtime_error("Invalid number of iterations " + std::to_string(iterations));
+      }
+      pruning = reader.read_string();
+      multiset_hash = reader.read<uint8_t>();
+      sample_budget = reader.read<int64_t>();
+      sample_seed = reader.read<int32_t>();
+      std::vector<int> flat_pairs = reader.read_vector<int>();
+      if (flat_pairs.size() % 2 != 0) {
+        throw std::runtime_error("Selected pairs have an odd number of colours");
       }
+      for (size_t i = 0; i < flat_pairs.size(); i += 2) {
+        selected_pairs.push_back({flat_pairs[i], flat_pairs[i + 1]});
+      }
+      signature_hash = reader.read<uint8_t>();
+      refinement = RefinementOptions::NODE;  // only written by wl-based generators
+      hash_dim = reader.read<int64_t>();
+      frequency_threshold = reader.read<double>();
+      frequency_sketch_width = reader.read<int64_t>();
+      quiet = reader.read<uint8_t>();
+      collected = reader.read<uint8_t>();
+      pruned = reader.read<uint8_t>();
+      collecting = false;
+      greedy_maxsat = false;
+
+      domain = std::make_shared<planning::Domain>(planning::read_domain(reader));
+
+      // each layer is stored as flat keys with offsets, and the colours of the keys
+      colour_hash = VecColourHash(reader.read_count());
+      for (size_t itr = 0; itr < colour_hash.size(); itr++) {
+        std::vector<int> offsets = reader.read_vector<int>();
+        std::vector<int> keys = reader.read_vector<int>();
+        std::vector<int> colours = reader.read_vector<int>();
+        if (offsets.size() != colours.size() + 1 || offsets[0] != 0 ||
+            offsets.back() != (int)keys.size()) {
+          throw std::runtime_error("Invalid colour keys of layer " + std::to_string(itr));
+        }
+        colour_hash[itr].reserve(colours.size());
+        for (size_t i = 0; i < colours.size(); i++) {
+          if (offsets[i] > offsets[i + 1]) {
+            throw std::runtime_error("Invalid colour keys of layer " + std::to_string(itr));
+          }
+          std::vector<int> key(keys.begin() + offsets[i], keys.begin() + offsets[i + 1]);
+          colour_hash[itr][key] = colours[i];
+        }
+      }
+
+      std::vector<int> colours = reader.read_vector<int>();
+      std::vector<int> layers = reader.read_vector<int>();
+      if (colours.size() != layers.size()) {
+        throw std::runtime_error("Colours and layers of the colour dictionary differ in size");
+      }
+      layer_to_colours = new_layer_to_colours();
+      for (size_t i = 0; i < colours.size(); i++) {
+        if (layers[i] < 0 || layers[i] > iterations) {
+          throw std::runtime_error("Invalid layer " + std::to_string(layers[i]));
+        }
+        colour_to_layer[colours[i]] = layers[i];
+        layer_to_colours[layers[i]].insert(colours[i]);
+      }
+
+      weights = reader.read_vector<double>();
+      std::vector<int64_t> indices = reader.read_vector<int64_t>();
+      std::vector<double> values = reader.read_vector<double>();
+      if (indices.size() != values.size()) {
+        throw std::runtime_error("Indices and values of sparse weights differ in size");
+      }
+      for (size_t i = 0; i < indices.size(); i++) {
+        sparse_weights[indices[i]] = values[i];
+      }
+      store_weights = !weights.empty() || !sparse_weights.empty();
+
+      initialise_variables();
     }
 
     void Features::set_problem(const planning::Problem &problem) {
@@ -194,6 +375,8 @@ namespace wlplan {
     int Features::get_colour_hash(const std::vector<int> &colour, const int iteration) {
       if (colour.size() == 0) {
         return UNSEEN_COLOUR;
+      } else if (hash_dim > 0) {
+        return get_hashed_colour(colour, iteration);
       } else if (!collecting && !colour_hash[iteration].count(colour)) {
 #ifdef DEBUGMODE
         std::cout << "UNSEEN ";
@@ -210,12 +393,23 @@ namespace wlplan {
     }
 
     int Features::get_colour_hash_fast(const std::vector<int> &colour, const int iteration) {
+      if (hash_dim > 0) {
+        return get_hashed_colour(colour, iteration);
+      }
       auto [it, inserted] = colour_hash[iteration].try_emplace(colour, get_n_colours());
       int ret = it->second;
       layer_to_colours[iteration].insert(ret);
       return ret;
     }
 
+    int Features::get_hashed_colour(const std::vector<int> &colour, const int iteration) const {
+      uint64_t h = utils::mix64(iteration);
+      for (const int c : colour) {
+        h = utils::mix64(h ^ (uint32_t)c);
+      }
+      return (int)(h >> 33);  // non-negative, so never UNSEEN_COLOUR
+    }
+
     std::map<int, int> Features::remap_colour_hash(std::set<int> &to_prune) {
 
       //////////////////////////////////////////
@@ -235,53 +429,64 @@ namespace wlplan {
 #endif
       //////////////////////////////////////////
 
-      // remap values
-      std::map<int, int> remap;
-      std::vector<std::vector<std::pair<std::vector<int>, int>>> new_hash_vec(
-          iterations + 1, std::vector<std::pair<std::vector<int>, int>>());
-      std::unordered_map<int, int> new_colour_layer;
+      int n_colours = 0;
+      for (int itr = 0; itr < iterations + 1; itr++) {
+        for (const auto &[key, val] : colour_hash.at(itr)) {
+          n_colours = std::max(n_colours, val + 1);
+        }
+      }
 
-      int modifications = 1;
-      int post_pruning_itr = 0;
-      while (modifications > 0) {
-        std::cout << "Post-pruning iteration " << post_pruning_itr << std::endl;
-        post_pruning_itr++;
-        modifications = 0;
-        for (int itr = 1; itr < iterations + 1; itr++) {
-          for (const auto &[key, val] : colour_hash.at(itr)) {
-            // if to_prune appears in any value or key in colour hash, discard it
-            if (to_prune.count(val) > 0) {
-              continue;
-            }
+      // index colours by the colours that appear in their keys, once, so that pruning can be
+      // propagated to descendants with a worklist instead of rescanning all keys to a fixpoint
+      std::vector<std::vector<int>> dependants(n_colours);
+      for (int itr = 1; itr < iterations + 1; itr++) {
+        for (const auto &[key, val] : colour_hash.at(itr)) {
+          for (const int neighbour : neighbour_container->get_neighbour_colours(key)) {
+            dependants.at(neighbour).push_back(val);
+          }
+        }
+      }
 
-            bool skip = false;
-            for (const int &neighbour : neighbour_container->get_neighbour_colours(key)) {
-              if (to_prune.count(neighbour) > 0) {
-                skip = true;
-                break;
-              }
-            }
-            if (skip) {
-              to_prune.insert(val);
-              modifications++;
-            }
+      std::vector<bool> is_pruned(n_colours, false);
+      std::vector<int> worklist;
+      for (const int colour : to_prune) {
+        if (colour >= 0 && colour < n_colours && !is_pruned[colour]) {
+          is_pruned[colour] = true;
+          worklist.push_back(colour);
+        }
+      }
+      int n_propagated = 0;
+      while (!worklist.empty()) {
+        int colour = worklist.back();
+        worklist.pop_back();
+        for (const int dependant : dependants[colour]) {
+          if (!is_pruned[dependant]) {
+            is_pruned[dependant] = true;
+            worklist.push_back(dependant);
+            to_prune.insert(dependant);
+            n_propagated++;
           }
         }
-        std::cout << "Pruned an additional " << modifications << " features" << std::endl;
+      }
+      if (n_propagated > 0) {
+        std::cout << "Pruned an additional " << n_propagated << " dependent features" << std::endl;
       }
 
+      // remap values in place, keeping the colour hash maps and their nodes
+      std::map<int, int> remap;
+      std::unordered_map<int, int> new_colour_layer;
       for (int itr = 0; itr < iterations + 1; itr++) {
-        for (const auto &[key, val] : colour_hash.at(itr)) {
-          // if to_prune appears in any value or key in colour hash, discard it
-          if (to_prune.count(val) > 0) {
+        ColourHash &hash = colour_hash.at(itr);
+        for (auto it = hash.begin(); it != hash.end();) {
+          if (is_pruned[it->second]) {
+            it = hash.erase(it);
             continue;
           }
-
-          // otherwise remap
           int new_val = remap.size();
-          remap[val] = new_val;
-          new_hash_vec[itr].push_back(std::make_pair(key, new_val));
-          new_colour_layer[new_val] = colour_to_layer[val];
+          remap[it->second] = new_val;
+          new_colour_layer[new_val] = colour_to_layer[it->second];
+          it->second = new_val;
+          ++it;
         }
       }
 
@@ -294,31 +499,23 @@ namespace wlplan {
 #endif
       //////////////////////////////////////////
 
-      // remap keys
-      VecColourHash new_hash(iterations + 1,
-                             std::unordered_map<std::vector<int>, int, int_vector_hasher>());
-
-      // layer 0 keeps same keys because they are from graph init node colours
-      for (size_t i = 0; i < new_hash_vec[0].size(); i++) {
-        std::vector<int> key = new_hash_vec[0][i].first;
-        int val = new_hash_vec[0][i].second;
-        new_hash[0][key] = val;
-      }
-
-      // other layers (>=1) remap keys
+      // remap keys of layers >= 1 by reinserting their nodes, as layer 0 keys are from graph init
+      // node colours; all nodes are extracted first so that new keys never clash with old ones
       for (int itr = 1; itr < iterations + 1; itr++) {
-        for (size_t i = 0; i < new_hash_vec[itr].size(); i++) {
-          std::vector<int> key = new_hash_vec[itr][i].first;
-          int val = new_hash_vec[itr][i].second;
-          if (new_colour_layer[val] > 0) {
-            key = neighbour_container->remap(key, remap);
+        ColourHash &hash = colour_hash.at(itr);
+        std::vector<ColourHash::node_type> nodes;
+        nodes.reserve(hash.size());
+        while (!hash.empty()) {
+          nodes.push_back(hash.extract(hash.begin()));
+        }
+        for (auto &node : nodes) {
+          if (new_colour_layer[node.mapped()] > 0) {
+            node.key() = neighbour_container->remap(node.key(), remap);
           }
-          new_hash[itr][key] = val;
+          hash.insert(std::move(node));
         }
       }
 
-      // remap hash
-      colour_hash = new_hash;
       colour_to_layer = new_colour_layer;
       layer_to_colours = new_layer_to_colours();
       for (int itr = 0; itr < iterations + 1; itr++) {
@@ -365,16 +562,77 @@ namespace wlplan {
       return remap;
     }
 
-    std::vector<graph_generator::Graph> Features::to_graphs(const data::DomainDataset dataset) {
+    std::vector<graph_generator::Graph> Features::to_graphs(const data::DomainDataset &dataset) {
       return graph_generator->to_graphs(dataset);
     }
 
-    void Features::collect_from_dataset(const data::DomainDataset dataset) {
+    void Features::collect_from_dataset(const data::DomainDataset &dataset) {
       if (graph_generator == nullptr) {
         throw std::runtime_error("No graph generator is set. Use graph input instead of dataset.");
       }
-      std::vector<graph_generator::Graph> graphs = to_graphs(dataset);
-      collect(graphs);
+      if (pruning != PruningOptions::NONE) {
+        // pruning needs the colours of all graphs at once
+        std::vector<graph_generator::Graph> graphs = to_graphs(dataset);
+        collect(graphs);
+        return;
+      }
+
+      // without pruning, graphs are independent and can be collected in chunks
+      graph_generator::GraphStream stream(*graph_generator, dataset);
+      collecting = true;
+      for (std::vector<graph_generator::Graph> graphs = stream.next_chunk(COLLECT_CHUNK_SIZE);
+           graphs.size() > 0;
+           graphs = stream.next_chunk(COLLECT_CHUNK_SIZE)) {
+        collect_graphs_chunk(graphs);
+      }
+      std::cout << "[complete]" << std::endl;
+      end_collect();
+    }
+
+    void Features::collect_problem(const planning::Problem &problem,
+                                   const std::vector<planning::State> &states) {
+      if (graph_generator == nullptr) {
+        throw std::runtime_error("No graph generator is set. Use graph input instead of states.");
+      }
+      if (pruning != PruningOptions::NONE) {
+        throw NotSupportedError("Collecting problem by problem with pruning option `" + pruning +
+                                "`. Use collect() instead.");
+      }
+
+      set_problem(problem);
+      collecting = true;
+      std::vector<graph_generator::Graph> graphs;
+      for (const planning::State &state : states) {
+        graphs.push_back(*graph_generator->to_graph(state));
+        if (graphs.size() == COLLECT_CHUNK_SIZE) {
+          collect_graphs_chunk(graphs);
+          graphs.clear();
+        }
+      }
+      collect_graphs_chunk(graphs);
+    }
+
+    void Features::collect_graphs_chunk(const std::vector<graph_generator::Graph> &graphs) {
+      if (hash_dim == 0 && graphs.size() > 0) {
+        collect_impl(graphs);
+      }
+    }
+
+    void Features::end_collect() {
+      if (!collecting) {
+        throw std::runtime_error("end_collect() must follow collect_problem()");
+      }
+      if (hash_dim == 0) {
+        layer_redundancy_check();
+      }
+
+      collected = true;
+      collecting = false;
+
+      // check features have been collected
+      if (get_n_colours() == 0) {
+        std::cout << "WARNING: no features have been collected" << std::endl;
+      }
     }
 
     void Features::collect(const std::vector<graph_generator::Graph> &graphs) {
@@ -382,6 +640,12 @@ namespace wlplan {
         throw std::runtime_error("Collect with pruning can only be called at most once");
       }
 
+      if (hash_dim > 0) {
+        // there is no dictionary to collect
+        collected = true;
+        return;
+      }
+
       collecting = true;
 
       collect_impl(graphs);
@@ -390,15 +654,126 @@ namespace wlplan {
 
       // bulk pruning
       prune_bulk(graphs);
-      layer_redundancy_check();
+      end_collect();
+    }
 
-      collected = true;
+    std::vector<int> Features::extend_from_dataset(const data::DomainDataset &dataset) {
+      if (graph_generator == nullptr) {
+        throw std::runtime_error("No graph generator is set. Use graph input instead of dataset.");
+      }
+      std::vector<graph_generator::Graph> graphs = to_graphs(dataset);
+      return extend(graphs);
+    }
+
+    std::vector<int> Features::extend(const std::vector<graph_generator::Graph> &graphs) {
+      if (std::set<std::string>({"ccwl", "ccwl-a"}).count(feature_name)) {
+        // feature indices are offset by the number of colours, so they would not be stable
+        throw NotSupportedError("extend() for feature option `" + feature_name + "`");
+      }
+      if (!collected) {
+        throw std::runtime_error("collect() must be called before extend()");
+      }
+      if (hash_dim > 0) {
+        return {};  // there is no dictionary to extend
+      }
+
+      // Pruning is only done at the first collection, as pruning new colours would require
+      // recomputing the features of the previous data. Pruned colours that reappear are treated
+      // as new colours.
+      int n_colours_before = get_n_colours();
+      std::string pruning_before = pruning;
+      pruning = PruningOptions::NONE;
+      collecting = true;
+      collect_impl(graphs);
       collecting = false;
+      pruning = pruning_before;
 
-      // check features have been collected
-      if (get_n_colours() == 0) {
-        std::cout << "WARNING: no features have been collected" << std::endl;
+      std::vector<int> new_colours(get_n_colours() - n_colours_before);
+      std::iota(new_colours.begin(), new_colours.end(), n_colours_before);
+
+      // new colours have not been trained on
+      if (!weights.empty()) {
+        weights.resize(get_n_features(), 0);
+      }
+
+      return new_colours;
+    }
+
+    std::pair<std::map<int, int>, std::map<int, int>> Features::merge(const Features &other) {
+      if (feature_name != other.feature_name ||
+          graph_representation != other.graph_representation || iterations != other.iterations ||
+          multiset_hash != other.multiset_hash || sample_budget != other.sample_budget ||
+          sample_seed != other.sample_seed || signature_hash != other.signature_hash ||
+          hash_dim != other.hash_dim || !(*domain == *other.domain)) {
+        throw std::runtime_error("Cannot merge feature generators with different configurations");
+      }
+      if (!collected || !other.collected) {
+        throw std::runtime_error("collect() must be called on both generators before merge()");
+      }
+      if (signature_hash) {
+        // signatures are hashes of colour ids, so they cannot be remapped
+        throw NotSupportedError("merge() with signature hashing");
+      }
+      if (!selected_pairs.empty() || !other.selected_pairs.empty()) {
+        throw NotSupportedError("merge() with selected pairs");
+      }
+
+      std::map<int, int> remap, other_remap;
+      if (hash_dim > 0) {
+        return std::make_pair(remap, other_remap);  // there are no dictionaries to merge
+      }
+
+      VecColourHash new_hash = new_colour_hash();
+      std::unordered_map<int, int> new_colour_layer;
+      int n_colours = 0;
+      for (int itr = 0; itr < iterations + 1; itr++) {
+        // keys in terms of the merged colours of previous layers; layer 0 keys are graph colours
+        std::vector<std::pair<std::vector<int>, int>> keys, other_keys;
+        for (const auto &[key, val] : colour_hash[itr]) {
+          keys.push_back(
+              std::make_pair(itr == 0 ? key : neighbour_container->remap(key, remap), val));
+        }
+        for (const auto &[key, val] : other.colour_hash[itr]) {
+          other_keys.push_back(
+              std::make_pair(itr == 0 ? key : neighbour_container->remap(key, other_remap), val));
+        }
+
+        // number the union of keys in sorted order
+        std::map<std::vector<int>, int> key_to_colour;
+        for (const auto &[key, val] : keys) {
+          key_to_colour[key] = -1;
+        }
+        for (const auto &[key, val] : other_keys) {
+          key_to_colour[key] = -1;
+        }
+        for (auto &[key, col] : key_to_colour) {
+          col = n_colours++;
+          new_hash[itr][key] = col;
+          new_colour_layer[col] = itr;
+        }
+
+        for (const auto &[key, val] : keys) {
+          remap[val] = key_to_colour.at(key);
+        }
+        for (const auto &[key, val] : other_keys) {
+          other_remap[val] = key_to_colour.at(key);
+        }
+      }
+
+      colour_hash = new_hash;
+      colour_to_layer = new_colour_layer;
+      layer_to_colours = new_layer_to_colours();
+      for (const auto &[col, layer] : colour_to_layer) {
+        layer_to_colours[layer].insert(col);
       }
+      pruned = pruned || other.pruned;
+
+      // weights were trained for different features
+      store_weights = false;
+      weights.clear();
+      sparse_weights.clear();
+
+      return std::make_pair(remap, other_remap);
     }
 
     std::unordered_map<int, int> Features::collect_embed(const planning::State &state) {
@@ -421,11 +796,31 @@ namespace wlplan {
 
     // overloaded embedding functions
     std::vector<Embedding> Features::embed_dataset(const data::DomainDataset &dataset) {
-      std::vector<graph_generator::Graph> graphs = to_graphs(dataset);
-      if (graphs.size() == 0) {
+      // graphs are embedded as they are produced instead of materialising all of them
+      std::vector<Embedding> X;
+      graph_generator::GraphStream stream(*graph_generator, dataset);
+      for (auto graph = stream.next(); graph != nullptr; graph = stream.next()) {
+        X.push_back(embed_impl(graph));
+      }
+      if (X.size() == 0) {
         throw std::runtime_error("No graphs to embed");
       }
-      return embed_graphs(graphs);
+      return X;
+    }
+
+    std::vector<Embedding> Features::embed_problem(const planning::Problem &problem,
+                                                   const std::vector<planning::State> &states) {
+      if (graph_generator == nullptr) {
+        throw std::runtime_error("No graph generator is set. Use graph input instead of states.");
+      }
+      set_problem(problem);
+      std::vector<Embedding> X;
+      X.reserve(states.size());
+      for (const planning::State &state : states) {
+        X.push_back(embed_impl(graph_generator->to_graph_opt(state)));
+        graph_generator->reset_graph();
+      }
+      return X;
     }
 
     std::vector<Embedding>
@@ -454,34 +849,134 @@ namespace wlplan {
       return embed_impl(graph);
     }
 
+    std::vector<SparseEmbedding>
+    Features::embed_sparse_dataset(const data::DomainDataset &dataset) {
+      std::vector<SparseEmbedding> X;
+      graph_generator::GraphStream stream(*graph_generator, dataset);
+      for (auto graph = stream.next(); graph != nullptr; graph = stream.next()) {
+        X.push_back(embed_sparse_impl(graph));
+      }
+      if (X.size() == 0) {
+        throw std::runtime_error("No graphs to embed");
+      }
+      return X;
+    }
+
+    std::vector<SparseEmbedding>
+    Features::embed_sparse_graphs(const std::vector<graph_generator::Graph> &graphs) {
+      std::vector<SparseEmbedding> X;
+      for (const auto &graph : graphs) {
+        X.push_back(embed_sparse_impl(std::make_shared<graph_generator::Graph>(graph)));
+      }
+      return X;
+    }
+
+    SparseEmbedding Features::embed_sparse_state(const planning::State &state) {
+      return embed_sparse_impl(graph_generator->to_graph(state));
+    }
+
+    SparseEmbedding
+    Features::embed_sparse_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
+      Embedding x = embed_impl(graph);
+      SparseEmbedding ret;
+      for (size_t i = 0; i < x.size(); i++) {
+        if (x[i] != 0) {
+          ret.push_back(std::make_pair(i, x[i]));
+        }
+      }
+      return ret;
+    }
+
     void Features::add_colour_to_x(int col, int itr, Embedding &x) {
       bool is_seen_colour = (col != UNSEEN_COLOUR);  // prevent branch prediction
       seen_colour_statistics[is_seen_colour][itr]++;
       if (is_seen_colour) {
-        x[col]++;
+        add_to_feature(col, 1, x);
+      }
+    }
+
+    void Features::add_colour_to_x(int col, int itr, Embedding &x, double weight) {
+      bool is_seen_colour = (col != UNSEEN_COLOUR);
+      seen_colour_statistics[is_seen_colour][itr]++;
+      if (is_seen_colour) {
+        add_to_feature(col, weight, x);
       }
     }
 
     /* Pruning functions (see pruning/ source files for specific implementations) */
 
     std::map<int, int> Features::get_equivalence_groups(const std::vector<Embedding> &X) {
-      std::map<int, int> feature_group;
-      int n_features = X[0].size();
-      std::unordered_map<std::vector<int>, int, int_vector_hasher> canonical_group;
-      for (int colour = 0; colour < n_features; colour++) {
-        std::vector<int> feature;
-        for (size_t j = 0; j < X.size(); j++) {
-          feature.push_back(X[j][colour]);
+      std::vector<SparseEmbedding> X_sparse;
+      X_sparse.reserve(X.size());
+      for (const Embedding &x : X) {
+        SparseEmbedding x_sparse;
+        for (size_t i = 0; i < x.size(); i++) {
+          if (x[i] != 0) {
+            x_sparse.push_back(std::make_pair(i, x[i]));
+          }
         }
+        X_sparse.push_back(x_sparse);
+      }
+      return get_equivalence_groups(X_sparse, X.at(0).size());
+    }
 
-        int group;
-        if (canonical_group.count(feature) == 0) {  // new feature
-          group = canonical_group.size();
-          canonical_group[feature] = group;
-        } else {  // seen this feature before
-          group = canonical_group.at(feature);
+    std::map<int, int> Features::get_equivalence_groups(const std::vector<SparseEmbedding> &X,
+                                                        int n_features) {
+      // 1. stream over the samples once to compute a 128-bit hash of each column, as the sum of
+      // the hashes of its non-zero (sample, value) entries
+      std::vector<uint64_t> hash_a(n_features, 0);
+      std::vector<uint64_t> hash_b(n_features, 0);
+      for (size_t j = 0; j < X.size(); j++) {
+        for (const auto &[colour, value] : X[j]) {
+          uint64_t bits;
+          std::memcpy(&bits, &value, sizeof(bits));
+          uint64_t h = utils::mix64(bits);
+          hash_a[colour] += utils::mix64(h ^ j);
+          hash_b[colour] += utils::mix64(h + j * 0xc2b2ae3d27d4eb4fULL);
         }
+      }
 
+      // 2. only columns that share a hash with another column are materialised, as sparse
+      // (sample, value) lists, to confirm that they are equal
+      std::unordered_map<uint64_t, int> bucket_size;
+      for (int colour = 0; colour < n_features; colour++) {
+        bucket_size[hash_a[colour]]++;
+      }
+      std::vector<int> colour_to_column(n_features, -1);
+      std::vector<std::vector<std::pair<size_t, double>>> columns;
+      for (int colour = 0; colour < n_features; colour++) {
+        if (bucket_size.at(hash_a[colour]) > 1) {
+          colour_to_column[colour] = columns.size();
+          columns.emplace_back();
+        }
+      }
+      for (size_t j = 0; j < X.size(); j++) {
+        for (const auto &[colour, value] : X[j]) {
+          if (colour_to_column[colour] != -1) {
+            columns[colour_to_column[colour]].push_back(std::make_pair(j, value));
+          }
+        }
+      }
+
+      // 3. groups are numbered in order of first occurrence, comparing each column against the
+      // representatives of the groups in its bucket
+      std::map<int, int> feature_group;
+      std::unordered_map<uint64_t, std::vector<std::pair<int, int>>> bucket_to_groups;
+      int n_groups = 0;
+      for (int colour = 0; colour < n_features; colour++) {
+        std::vector<std::pair<int, int>> &groups = bucket_to_groups[hash_a[colour]];
+        int group = -1;
+        for (const auto &[representative, rep_group] : groups) {
+          if (hash_b[representative] == hash_b[colour] &&
+              columns[colour_to_column[representative]] == columns[colour_to_column[colour]]) {
+            group = rep_group;
+            break;
+          }
+        }
+        if (group == -1) {  // new feature
+          group = n_groups++;
+          groups.push_back(std::make_pair(colour, group));
+        }
         feature_group[colour] = group;
       }
 
@@ -495,8 +990,18 @@ namespace wlplan {
         throw std::runtime_error("Weights have not been set for prediction.");
       }
 
-      Embedding x = embed_impl(graph);
-      double h = std::inner_product(x.begin(), x.end(), weights.begin(), 0.0);
+      return predict_impl(graph);
+    }
+
+    double Features::predict_impl(const std::shared_ptr<graph_generator::Graph> &graph) {
+      if (!weights.empty()) {
+        Embedding x = embed_impl(graph);
+        return std::inner_product(x.begin(), x.end(), weights.begin(), 0.0);
+      }
+      double h = 0;
+      for (const auto &[index, value] : embed_sparse_impl(graph)) {
+        h += value * get_weight(index);
+      }
       return h;
     }
 
@@ -598,7 +1103,7 @@ namespace wlplan {
     }
 
     void Features::set_weights(const std::vector<double> &weights) {
-      if (((int)weights.size()) != get_n_features()) {
+      if (((long)weights.size()) != get_n_features()) {
         std::string msg = "Number of weights (" + std::to_string(weights.size()) + ") " +
                           "must match number of features (" + std::to_string(get_n_features()) +
                           ").";
@@ -606,18 +1111,61 @@ namespace wlplan {
       }
       store_weights = true;
       this->weights = weights;
+      sparse_weights.clear();
+    }
+
+    void Features::set_sparse_weights(const SparseEmbedding &weights) {
+      long n_features = get_n_features();
+      std::unordered_map<long, double> new_sparse_weights;
+      for (const auto &[index, weight] : weights) {
+        if (index < 0 || index >= n_features) {
+          throw std::runtime_error("Weight index " + std::to_string(index) +
+                                   " out of range for " + std::to_string(n_features) +
+                                   " features.");
+        }
+        if (weight != 0) {
+          new_sparse_weights[index] = weight;
+        }
+      }
+      store_weights = true;
+      this->weights.clear();
+      sparse_weights = new_sparse_weights;
     }
 
     std::vector<double> Features::get_weights() const {
       if (!store_weights) {
         throw std::runtime_error("Cannot get weights as they are not stored.");
       }
+      if (weights.empty()) {
+        throw std::runtime_error("Weights are stored sparsely. Use get_sparse_weights() instead.");
+      }
       return weights;
     }
 
+    SparseEmbedding Features::get_sparse_weights() const {
+      if (!store_weights) {
+        throw std::runtime_error("Cannot get weights as they are not stored.");
+      }
+      SparseEmbedding ret;
+      if (!weights.empty()) {
+        for (size_t i = 0; i < weights.size(); i++) {
+          if (weights[i] != 0) {
+            ret.push_back(std::make_pair(i, weights[i]));
+          }
+        }
+      } else {
+        ret = SparseEmbedding(sparse_weights.begin(), sparse_weights.end());
+        std::sort(ret.begin(), ret.end());
+      }
+      return ret;
+    }
+
     void Features::print_init_colours() const { graph_generator->print_init_colours(); }
 
     int Features::get_n_colours() const {
+      if (hash_dim > 0) {
+        return hash_dim;  // buckets take the place of colours
+      }
       int ret = 0;
       for (int i = 0; i < iterations + 1; i++) {
         ret += colour_hash[i].size();
@@ -648,6 +1196,16 @@ namespace wlplan {
       j["iterations"] = iterations;
       j["pruning"] = pruning;
       j["multiset_hash"] = multiset_hash;
+      j["sample_budget"] = sample_budget;
+      j["sample_seed"] = sample_seed;
+      if (!selected_pairs.empty()) {
+        j["selected_pairs"] = selected_pairs;
+      }
+      j["signature_hash"] = signature_hash;
+      j["refinement"] = refinement;
+      j["hash_dim"] = hash_dim;
+      j["frequency_threshold"] = frequency_threshold;
+      j["frequency_sketch_width"] = frequency_sketch_width;
 
       j["domain"] = domain->to_json();
 
@@ -655,6 +1213,9 @@ namespace wlplan {
       j["colour_to_layer"] = colour_to_layer;
 
       j["weights"] = weights;
+      if (!sparse_weights.empty()) {
+        j["sparse_weights"] = get_sparse_weights();
+      }
 
       // Create directory if it doesn't exist
       if (filename.find_last_of("/") != std::string::npos) {
@@ -675,5 +1236,65 @@ namespace wlplan {
       set_weights(weights);
       save(filename);
     }
+
+    void Features::write(utils::BinaryWriter &writer) const {
+      writer.write_string(feature_name);
+      writer.write_string(package_version);
+      writer.write_string(graph_representation);
+      writer.write<int32_t>(iterations);
+      writer.write_string(pruning);
+      writer.write<uint8_t>(multiset_hash);
+      writer.write<int64_t>(sample_budget);
+      writer.write<int32_t>(sample_seed);
+      std::vector<int> flat_pairs;
+      for (const auto &[i, j] : selected_pairs) {
+        flat_pairs.push_back(i);
+        flat_pairs.push_back(j);
+      }
+      writer.write_vector(flat_pairs);
+      writer.write<uint8_t>(signature_hash);
+      writer.write<int64_t>(hash_dim);
+      writer.write<double>(frequency_threshold);
+      writer.write<int64_t>(frequency_sketch_width);
+      writer.write<uint8_t>(quiet);
+      writer.write<uint8_t>(collected);
+      writer.write<uint8_t>(pruned);
+
+      planning::write_domain(writer, *domain);
+
+      writer.write<uint64_t>(colour_hash.size());
+      for (const ColourHash &layer : colour_hash) {
+        std::vector<int> offsets = {0};
+        std::vector<int> keys;
+        std::vector<int> colours;
+        for (const auto &[key, colour] : layer) {
+          keys.insert(keys.end(), key.begin(), key.end());
+          offsets.push_back(keys.size());
+          colours.push_back(colour);
+        }
+        writer.write_vector(offsets);
+        writer.write_vector(keys);
+        writer.write_vector(colours);
+      }
+
+      std::vector<int> colours;
+      std::vector<int> layers;
+      for (const auto &[colour, layer] : colour_to_layer) {
+        colours.push_back(colour);
+        layers.push_back(layer);
+      }
+      writer.write_vector(colours);
+      writer.write_vector(layers);
+
+      writer.write_vector(weights);
+      std::vector<int64_t> indices;
+      std::vector<double> values;
+      for (const auto &[index, weight] : sparse_weights) {
+        indices.push_back(index);
+        values.push_back(weight);
+      }
+      writer.write_vector(indices);
+      writer.write_vector(values);
+    }
   }  // namespace feature_generator
 }  // namespace wlplan
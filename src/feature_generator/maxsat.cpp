@@ -2,8 +2,10 @@
 
 #include "../../include/utils/exceptions.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <numeric>
 
 #ifndef NOPYTHON
 #include <pybind11/embed.h>
@@ -100,21 +102,53 @@ namespace wlplan {
       // return ret;
     }
 
-    std::map<int, int> MaxSatProblem::call_solver() {
-#ifndef NOPYTHON
+    void MaxSatProblem::to_literals(std::vector<std::vector<int>> &hard,
+                                    std::vector<std::vector<int>> &soft,
+                                    std::vector<int> &weights) const {
+      for (const MaxSatClause &clause : clauses) {
+        std::vector<int> literals(clause.size());
+        for (int i = 0; i < clause.size(); i++) {
+          literals[i] = clause.negated[i] ? -clause.variables[i] : clause.variables[i];
+        }
+        if (clause.hard) {
+          hard.push_back(std::move(literals));
+        } else {
+          soft.push_back(std::move(literals));
+          weights.push_back(clause.weight);
+        }
+      }
+    }
 
-      std::string maxsat_wcnf_string = to_string();
+    std::map<int, int> MaxSatProblem::call_solver(bool allow_greedy) {
+#ifndef NOPYTHON
+      py::object pysat_rc2;
+      py::object pysat_wcnf;
+      try {
+        pysat_rc2 = py::module::import("pysat.examples.rc2").attr("RC2");
+        pysat_wcnf = py::module::import("pysat.formula").attr("WCNF");
+      } catch (const py::error_already_set &) {
+        if (!allow_greedy) {
+          throw py::import_error("MaxSAT pruning requires pysat (pip install python-sat), or an "
+                                 "approximate solution with set_greedy_maxsat(True)");
+        }
+        std::cout << "pysat is not available, falling back to the greedy solver." << std::endl;
+        return solve_greedy();
+      }
 
 #ifdef DEBUGMODE
-      std::cout << maxsat_wcnf_string << std::endl;
+      std::cout << to_string() << std::endl;
 #endif
 
-      py::object pysat_rc2 = py::module::import("pysat.examples.rc2").attr("RC2");
-      py::object pysat_wcnf = py::module::import("pysat.formula").attr("WCNF");
-      py::dict kwargs;
-      kwargs["from_string"] = maxsat_wcnf_string;
-      py::object wncf = pysat_wcnf(**kwargs);
-      py::object rc2 = pysat_rc2(wncf);
+      // pass clauses as nested lists instead of a WCNF string for pysat to parse
+      std::vector<std::vector<int>> hard, soft;
+      std::vector<int> weights;
+      to_literals(hard, soft, weights);
+      std::cout << "  Variables: " << get_n_variables() << std::endl;
+      std::cout << "  Clauses: " << clauses.size() << std::endl;
+      py::object wcnf = pysat_wcnf();
+      wcnf.attr("extend")(hard);
+      wcnf.attr("extend")(soft, py::arg("weights") = weights);
+      py::object rc2 = pysat_rc2(wcnf);
 
       std::cout << "Solving MaxSAT with RC2." << std::endl;
       auto t1 = high_resolution_clock::now();
@@ -137,23 +171,122 @@ namespace wlplan {
       }
       return solution;
 #else
-      throw NotSupportedError("MaxSAT feature pruning for C++ interface");
+      (void)allow_greedy;  // pysat is not available without Python
+      return solve_greedy();
 #endif
     }
 
-    std::map<int, int> MaxSatProblem::solve() {
+    std::map<int, int> MaxSatProblem::solve(bool allow_greedy) {
 #ifndef NOPYTHON
       if (Py_IsInitialized() == 0) {
         // interpreter is not running
         py::scoped_interpreter guard{};
-        return call_solver();
+        return call_solver(allow_greedy);
       } else {
         // interpreter is running (e.g. Python calling wlplan)
-        return call_solver();
+        return call_solver(allow_greedy);
       }
 #else
-      throw NotSupportedError("MaxSAT feature pruning for C++ interface");
+      (void)allow_greedy;  // pysat is not available without Python
+      return solve_greedy();
 #endif
     }
+
+    std::map<int, int> MaxSatProblem::solve_greedy() {
+      std::vector<std::vector<int>> hard, soft;
+      std::vector<int> weights;
+      to_literals(hard, soft, weights);
+      for (const std::vector<int> &literals : soft) {
+        if (literals.size() != 1 || literals[0] < 0) {
+          throw NotSupportedError("Greedy MaxSAT solver for soft clauses that are not positive units");
+        }
+      }
+
+      // implied[a] contains b for each (a | ~b), i.e. setting a to false forces b to false
+      int max_variable = variables.empty() ? 0 : *variables.rbegin();
+      std::vector<std::vector<int>> implied(max_variable + 1);
+      std::vector<std::vector<int>> at_least_one_false;
+      for (const std::vector<int> &literals : hard) {
+        int n_positive = std::count_if(literals.begin(), literals.end(), [](int l) { return l > 0; });
+        if (n_positive == 0) {
+          at_least_one_false.push_back(literals);
+        } else if (literals.size() == 2 && n_positive == 1) {
+          int a = literals[0] > 0 ? literals[0] : literals[1];
+          int b = literals[0] > 0 ? -literals[1] : -literals[0];
+          implied[a].push_back(b);
+        } else {
+          throw NotSupportedError("Greedy MaxSAT solver for hard clauses of this form");
+        }
+      }
+
+      std::cout << "Solving MaxSAT greedily." << std::endl;
+      auto t1 = high_resolution_clock::now();
+
+      std::vector<bool> value(max_variable + 1, true);
+      std::vector<int> mark(max_variable + 1, -1);
+      std::vector<int> stack;
+      // variables that are still true and would be set to false with variable
+      auto closure = [&](int variable, int stamp) {
+        std::vector<int> ret;
+        stack.assign(1, variable);
+        mark[variable] = stamp;
+        while (!stack.empty()) {
+          int v = stack.back();
+          stack.pop_back();
+          ret.push_back(v);
+          for (const int w : implied[v]) {
+            if (value[w] && mark[w] != stamp) {
+              mark[w] = stamp;
+              stack.push_back(w);
+            }
+          }
+        }
+        return ret;
+      };
+
+      // satisfy clauses with fewer choices first, e.g. singleton groups that must be kept
+      std::vector<int> order(at_least_one_false.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), [&](int i, int j) {
+        return at_least_one_false[i].size() < at_least_one_false[j].size();
+      });
+
+      int stamp = 0;
+      for (const int clause_i : order) {
+        const std::vector<int> &literals = at_least_one_false[clause_i];
+        bool satisfied = false;
+        for (const int l : literals) {
+          satisfied = satisfied || !value[-l];
+        }
+        if (satisfied) {
+          continue;
+        }
+        std::vector<int> best;
+        for (const int l : literals) {
+          std::vector<int> flipped = closure(-l, stamp++);
+          if (best.empty() || flipped.size() < best.size()) {
+            best = std::move(flipped);
+          }
+        }
+        for (const int v : best) {
+          value[v] = false;
+        }
+      }
+
+      auto t2 = high_resolution_clock::now();
+      duration<double, std::milli> ms_double = t2 - t1;
+      std::map<int, int> solution;
+      for (const int variable : variables) {
+        solution[variable] = value[variable];
+      }
+      int cost = 0;
+      for (size_t i = 0; i < soft.size(); i++) {
+        cost += value[soft[i][0]] ? 0 : weights[i];
+      }
+      std::cout << "MaxSAT solved!" << std::endl;
+      std::cout << "  Solving time: " << ms_double.count() / 1000 << "s\n";
+      std::cout << "  Solution cost: " << cost << std::endl;
+      return solution;
+    }
   }  // namespace feature_generator
 }  // namespace wlplan
@@ -7,10 +7,17 @@ namespace wlplan {
     KWL2NeighbourContainer::KWL2NeighbourContainer(bool multiset_hash)
         : WLNeighbourContainer(multiset_hash) {}
 
+    std::vector<std::tuple<int, int, int>>
+    KWL2NeighbourContainer::deconstruct_pairs(const std::vector<int> &colours) {
+      std::vector<int> wl_key(colours.begin() + 1, colours.end());
+      wl_key.push_back(colours.at(0));
+      return deconstruct(wl_key);
+    }
+
     std::vector<int>
     KWL2NeighbourContainer::get_neighbour_colours(const std::vector<int> &colours) {
       std::set<int> neighbour_colours_set;
-      for (const auto &[col0, col1, n_occurrences] : deconstruct(colours)) {
+      for (const auto &[col0, col1, n_occurrences] : deconstruct_pairs(colours)) {
         neighbour_colours_set.insert(col0);
         neighbour_colours_set.insert(col1);
       }
@@ -28,7 +35,7 @@ namespace wlplan {
 
       std::vector<int> output = {remap.at(input.at(0))};
 
-      for (const auto &[col0, col1, n_occurrences] : deconstruct(input)) {
+      for (const auto &[col0, col1, n_occurrences] : deconstruct_pairs(input)) {
         for (int i = 0; i < n_occurrences; i++) {
           insert(remap.at(col0), remap.at(col1));
         }
@@ -21,7 +21,7 @@ namespace wlplan {
 
       std::vector<int> output = {remap.at(input.at(0))};
 
-      for (const auto &[col0, col1, n_occurrences] : deconstruct(input)) {
+      for (const auto &[col0, col1, n_occurrences] : deconstruct_pairs(input)) {
         for (int i = 0; i < n_occurrences; i++) {
           int col_a = std::min(remap.at(col0), remap.at(col1));
           int col_b = std::max(remap.at(col0), remap.at(col1));
@@ -48,10 +48,13 @@ namespace wlplan {
     WLNeighbourContainerMk2::deconstruct(const std::vector<int> &colours) {
       std::vector<std::tuple<int, int, int>> output;
 
+      // the last element is the node's own colour
+      std::vector<int> neighbours(colours.begin(), colours.end() - 1);
+
       if (multiset_hash) {
         std::map<std::pair<int, int>, int> count_map;
 
-        for (const int &key : colours) {
+        for (const int &key : neighbours) {
           int edge_label = key % n_relations;
           int node_colour = key / n_relations;
           count_map.try_emplace(std::make_pair(node_colour, edge_label), 0);
@@ -62,7 +65,7 @@ namespace wlplan {
           output.push_back(std::tuple<int, int, int>(key.first, key.second, count));
         }
       } else {
-        for (const int &key : colours) {
+        for (const int &key : neighbours) {
           int edge_label = key % n_relations;
           int node_colour = key / n_relations;
           int n_occurrences = 1;  // In the set case, each key is unique
@@ -1,6 +1,7 @@
 #include "../../../include/feature_generator/features.hpp"
 #include "../../../include/feature_generator/maxsat.hpp"
 
+#include <algorithm>
 #include <queue>
 
 const int KEEP = -1;
@@ -13,7 +14,7 @@ namespace wlplan {
       pruned = true;
       if (pruning == PruningOptions::ALL_MAXSAT) {
         collected = true;
-        std::vector<Embedding> X = embed_graphs(graphs);
+        std::vector<SparseEmbedding> X = embed_sparse_graphs(graphs);
         to_prune = prune_maxsat(X, iterations);
       } else {
         to_prune = std::set<int>();
@@ -25,36 +26,36 @@ namespace wlplan {
       }
     }
 
-    std::set<int> Features::prune_maxsat(std::vector<Embedding> X, const int maxsat_iterations) {
+    std::set<int> Features::prune_maxsat(const std::vector<SparseEmbedding> &X,
+                                         const int maxsat_iterations) {
       std::set<int> to_prune;
       std::cout << "Minimising equivalent features..." << std::endl;
 
-      // 0. construct feature dependency graph
-      int n_features = X.at(0).size();
-      std::vector<std::set<int>> edges_fw = std::vector<std::set<int>>(n_features, std::set<int>());
-      std::vector<std::set<int>> edges_bw = std::vector<std::set<int>>(n_features, std::set<int>());
+      // 0. construct feature dependency graph as sorted ancestor lists
+      int n_features = get_n_colours();
+      std::vector<std::vector<int>> edges_bw(n_features);
 
       for (int itr = 1; itr < maxsat_iterations + 1; itr++) {
         // neighbours: std::vector<int>; colour: int
         for (const auto &[neighbours, colour] : colour_hash[itr]) {
-          for (const int ancestor : neighbour_container->get_neighbour_colours(neighbours)) {
-            edges_fw.at(ancestor).insert(colour);
-            edges_bw.at(colour).insert(ancestor);
-          }
+          std::vector<int> &ancestors = edges_bw.at(colour);
+          ancestors = neighbour_container->get_neighbour_colours(neighbours);
+          std::sort(ancestors.begin(), ancestors.end());
+          ancestors.erase(std::unique(ancestors.begin(), ancestors.end()), ancestors.end());
         }
       }
 
 #ifdef DEBUGMODE
       for (int colour = 0; colour < n_features; colour++) {
-        for (const int child : edges_fw.at(colour)) {
-          std::cout << "FDG " << colour << " -> " << child << std::endl;
+        for (const int ancestor : edges_bw.at(colour)) {
+          std::cout << "FDG " << ancestor << " -> " << colour << std::endl;
         }
       }
 #endif
 
       // 1. compute equivalence groups
       std::cout << "Computing equivalence groups." << std::endl;
-      std::map<int, int> feature_group = get_equivalence_groups(X);
+      std::map<int, int> feature_group = get_equivalence_groups(X, n_features);
       std::map<int, std::set<int>> group_to_features;
       for (const auto &[feature, group] : feature_group) {
         if (group_to_features.count(group) == 0) {
@@ -97,7 +98,7 @@ namespace wlplan {
       MaxSatProblem max_sat_problem = MaxSatProblem(clauses);
 
       // time the solver
-      std::map<int, int> solution = max_sat_problem.solve();
+      std::map<int, int> solution = max_sat_problem.solve(greedy_maxsat);
 
       for (const auto &[colour, value] : solution) {
         if (value == 1) {
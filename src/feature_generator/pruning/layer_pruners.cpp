@@ -1,56 +1,140 @@
 #include "../../../include/feature_generator/features.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace wlplan {
   namespace feature_generator {
 
-    void Features::prune_this_iteration(int iteration,
-                                        const std::vector<graph_generator::Graph> &graphs,
-                                        std::vector<std::vector<int>> &cur_colours) {
+    void Features::init_layer_pruning(const std::vector<std::vector<int>> &cur_colours) {
+      layer_colour_counts.clear();
+      if (pruning != PruningOptions::LAYER_FREQUENCY) {
+        layer_colour_counts = std::vector<std::unordered_map<int, int>>(cur_colours.size());
+        add_layer_colour_counts(cur_colours);
+      }
+
+      // initial colours are only counted for the frequency pruning of the first iteration
+      colour_frequencies.clear();
+      colour_frequency_sketch = utils::CountMinSketch(std::max(frequency_sketch_width, 1L));
+      if (pruning == PruningOptions::LAYER_FREQUENCY ||
+          pruning == PruningOptions::LAYER_MAXSAT_FREQUENCY) {
+        add_colour_frequencies(cur_colours);
+      }
+    }
+
+    void Features::add_layer_colour_counts(const std::vector<std::vector<int>> &cur_colours) {
+      for (size_t graph_i = 0; graph_i < cur_colours.size(); graph_i++) {
+        for (const int col : cur_colours[graph_i]) {
+          if (col != UNSEEN_COLOUR) {
+            layer_colour_counts[graph_i][col]++;
+          }
+        }
+      }
+    }
+
+    void Features::add_colour_frequencies(const std::vector<std::vector<int>> &cur_colours) {
+      if (frequency_sketch_width == 0) {
+        colour_frequencies.resize(get_n_colours(), 0);
+      }
+      for (const std::vector<int> &colours : cur_colours) {
+        for (const int col : colours) {
+          if (col == UNSEEN_COLOUR) {
+            continue;
+          } else if (frequency_sketch_width == 0) {
+            colour_frequencies[col]++;
+          } else {
+            colour_frequency_sketch.add(col, 1);
+          }
+        }
+      }
+    }
+
+    long Features::get_colour_frequency(int colour) const {
+      if (frequency_sketch_width == 0) {
+        return colour < (int)colour_frequencies.size() ? colour_frequencies[colour] : 0;
+      }
+      return colour_frequency_sketch.estimate(colour);
+    }
+
+    std::vector<SparseEmbedding> Features::get_layer_pruning_X() const {
+      // equal to embedding the graphs up to the current layer, as the colours of earlier layers
+      // are remapped along with the colour hash and all their descendants are pruned with them
+      std::vector<SparseEmbedding> X(layer_colour_counts.size());
+      for (size_t graph_i = 0; graph_i < layer_colour_counts.size(); graph_i++) {
+        for (const auto &[col, count] : layer_colour_counts[graph_i]) {
+          X[graph_i].push_back(std::make_pair(col, count));
+        }
+        std::sort(X[graph_i].begin(), X[graph_i].end());
+      }
+      return X;
+    }
+
+    void Features::prune_this_iteration(int iteration, std::vector<std::vector<int>> &cur_colours) {
+      if (pruning != PruningOptions::LAYER_FREQUENCY) {
+        add_layer_colour_counts(cur_colours);
+      }
+      if (pruning == PruningOptions::LAYER_FREQUENCY ||
+          pruning == PruningOptions::LAYER_MAXSAT_FREQUENCY) {
+        add_colour_frequencies(cur_colours);
+      }
+
       std::set<int> to_prune;
       pruned = true;
       if (pruning == PruningOptions::LAYER_GREEDY) {
-        to_prune = prune_collapse_layer_greedy(iteration, graphs);
+        to_prune = prune_collapse_layer_greedy(iteration, get_layer_pruning_X());
       } else if (pruning == PruningOptions::LAYER_MAXSAT) {
-        to_prune = prune_collapse_layer_maxsat(iteration, graphs);
+        to_prune = prune_collapse_layer_maxsat(iteration, get_layer_pruning_X());
       } else if (pruning == PruningOptions::LAYER_FREQUENCY) {
-        to_prune = prune_collapse_layer_frequency(iteration, graphs);
+        to_prune = prune_collapse_layer_frequency(iteration, cur_colours.size());
       } else if (pruning == PruningOptions::LAYER_MAXSAT_FREQUENCY) {
-        to_prune = prune_collapse_layer_maxsat(iteration, graphs);
-        std::set<int> to_prune_f = prune_collapse_layer_frequency(iteration, graphs);
+        to_prune = prune_collapse_layer_maxsat(iteration, get_layer_pruning_X());
+        std::set<int> to_prune_f = prune_collapse_layer_frequency(iteration, cur_colours.size());
         to_prune.insert(to_prune_f.begin(), to_prune_f.end());
       } else {
         to_prune = std::set<int>();
         pruned = false;
       }
 
+      // frequencies are per layer, as colours of earlier layers keep their counts and have
+      // already survived frequency pruning
+      colour_frequencies.clear();
+      colour_frequency_sketch.clear();
+
       if (to_prune.size() != 0) {
         std::cout << "Pruning " << to_prune.size() << " features." << std::endl;
         std::map<int, int> remap = remap_colour_hash(to_prune);
-        for (size_t graph_i = 0; graph_i < graphs.size(); graph_i++) {
+        for (size_t graph_i = 0; graph_i < cur_colours.size(); graph_i++) {
           for (size_t node_i = 0; node_i < cur_colours[graph_i].size(); node_i++) {
             int col = cur_colours[graph_i][node_i];
-            if (remap.count(col) > 0) {
-              cur_colours[graph_i][node_i] = remap[col];
-            } else {
-              cur_colours[graph_i][node_i] = UNSEEN_COLOUR;
+            auto it = remap.find(col);
+            cur_colours[graph_i][node_i] = it == remap.end() ? UNSEEN_COLOUR : it->second;
+          }
+        }
+
+        // pruned colours no longer appear in later layers, so their counts are dropped
+        for (std::unordered_map<int, int> &graph_counts : layer_colour_counts) {
+          std::unordered_map<int, int> counts;
+          for (const auto &[col, count] : graph_counts) {
+            auto it = remap.find(col);
+            if (it != remap.end()) {
+              counts[it->second] = count;
             }
           }
+          graph_counts = std::move(counts);
         }
       }
+
+      if (iteration == iterations) {
+        layer_colour_counts.clear();
+      }
     }
 
     std::set<int>
     Features::prune_collapse_layer_greedy(int iteration,
-                                          const std::vector<graph_generator::Graph> &graphs) {
+                                          const std::vector<SparseEmbedding> &X) {
       // As in Bonet et al. 2019
-      int original_iterations = iterations;
-      iterations = iteration;
-      collecting = false;
-      collected = true;
-
       std::set<int> features_to_prune;
-      std::vector<Embedding> X = embed_graphs(graphs);
-      std::map<int, int> feature_group = get_equivalence_groups(X);
+      std::map<int, int> feature_group = get_equivalence_groups(X, get_n_colours());
       std::map<int, std::vector<int>> group_to_features;
       for (const auto &[colour, group] : feature_group) {
         if (group_to_features.count(group) == 0) {
@@ -73,62 +157,32 @@ namespace wlplan {
         }
       }
 
-      collecting = true;
-      collected = false;
-      iterations = original_iterations;
-
       return features_to_prune;
     }
 
     std::set<int>
     Features::prune_collapse_layer_maxsat(int iteration,
-                                          const std::vector<graph_generator::Graph> &graphs) {
+                                          const std::vector<SparseEmbedding> &X) {
       // MaxSAT but per layer
-      int original_iterations = iterations;
-      iterations = iteration;
-      collecting = false;
-      collected = true;
-
-      std::vector<Embedding> X = embed_graphs(graphs);
-      std::set<int> to_prune = prune_maxsat(X, iterations);
-
-      collecting = true;
-      collected = false;
-      iterations = original_iterations;
-
-      return to_prune;
+      return prune_maxsat(X, iteration);
     }
 
-    std::set<int>
-    Features::prune_collapse_layer_frequency(int iteration,
-                                             const std::vector<graph_generator::Graph> &graphs) {
-      // Frequency count < 1% of n_data
-      int original_iterations = iterations;
-      iterations = iteration;
-      collecting = false;
-      collected = true;
-
+    std::set<int> Features::prune_collapse_layer_frequency(int iteration, size_t n_graphs) {
+      // Frequency count <= frequency_threshold of n_data, for colours of this layer and also of
+      // the initial layer in the first iteration
       std::set<int> to_prune;
-      std::vector<Embedding> X = embed_graphs(graphs);
-      int N = (int)X.size();
-      int D = (int)X.at(0).size();
-      int one_percent = N / 100;
-      for (int i = 0; i < D; i++) {
-        int count = 0;
-        for (int j = 0; j < N; j++) {
-          count += X.at(j).at(i);
+      long max_count = (long)std::floor(frequency_threshold * n_graphs + 1e-9);
+      for (const auto &[colour, layer] : colour_to_layer) {
+        if (layer != iteration && !(iteration == 1 && layer == 0)) {
+          continue;
         }
-        if (count <= one_percent) {
-          to_prune.insert(i);
+        if (get_colour_frequency(colour) <= max_count) {
+          to_prune.insert(colour);
         }
       }
 
-      collecting = true;
-      collected = false;
-      iterations = original_iterations;
-
-      std::cout << "Pruning " << to_prune.size() << " features with <1% frequency count."
-                << std::endl;
+      std::cout << "Pruning " << to_prune.size() << " features with frequency count <= "
+                << max_count << "." << std::endl;
 
       return to_prune;
     }
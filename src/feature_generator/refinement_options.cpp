@@ -0,0 +1,14 @@
+#include "../../include/feature_generator/refinement_options.hpp"
+
+namespace wlplan {
+  namespace feature_generator {
+    const std::string RefinementOptions::NODE = "node";
+    const std::string RefinementOptions::PARTITION = "partition";
+    const std::vector<std::string> RefinementOptions::get_all() {
+      return {
+          NODE,
+          PARTITION,
+      };
+    }
+  }  // namespace feature_generator
+}  // namespace wlplan
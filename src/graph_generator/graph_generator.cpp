@@ -1,9 +1,10 @@
 #include "../../include/graph_generator/graph_generator.hpp"
 
+#include "../../include/graph_generator/graph_stream.hpp"
 #include "../../include/utils/exceptions.hpp"
 
 namespace wlplan::graph_generator {
-  GraphGenerator::GraphGenerator(const planning::Domain &domain,
+  GraphGenerator::GraphGenerator(const std::shared_ptr<const planning::Domain> &domain,
                                  const bool differentiate_constant_objects,
                                  const std::string &graph_generator_name)
       : domain(domain),
@@ -13,9 +14,9 @@ namespace wlplan::graph_generator {
 
     // add constant object colours
     if (differentiate_constant_objects) {
-      for (size_t i = 0; i < domain.constant_objects.size(); i++) {
+      for (size_t i = 0; i < domain->constant_objects.size(); i++) {
         int colour = -(i + 1);
-        colour_to_description[colour] = domain.constant_objects[i] + " _CONSTANT_";
+        colour_to_description[colour] = domain->constant_objects[i] + " _CONSTANT_";
       }
     }
 
@@ -32,23 +33,13 @@ namespace wlplan::graph_generator {
     return to_graph(state, action_pointers);
   }
 
-  std::vector<Graph> GraphGenerator::to_graphs(const data::DomainDataset dataset) {
+  std::vector<Graph> GraphGenerator::to_graphs(const data::DomainDataset &dataset) {
     std::vector<Graph> graphs;
+    graphs.reserve(dataset.get_size());
 
-    const std::vector<data::ProblemDataset> &data = dataset.data;
-    for (size_t i = 0; i < data.size(); i++) {
-      const auto &d = data.at(i);
-      const auto &problem = d.problem;
-      const auto &states = d.states;
-      const auto &actions = d.actions;
-      set_problem(problem);
-      for (size_t j = 0; j < states.size(); j++) {
-        planning::ActionPointers action_pointers;
-        for (const auto &action : actions.at(j)) {
-          action_pointers.push_back(std::make_shared<planning::Action>(action));
-        }
-        graphs.push_back(*(to_graph(states.at(j), action_pointers)));
-      }
+    GraphStream stream(*this, dataset);
+    for (auto graph = stream.next(); graph != nullptr; graph = stream.next()) {
+      graphs.push_back(*graph);
     }
 
     return graphs;
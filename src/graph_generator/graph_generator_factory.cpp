@@ -7,8 +7,9 @@
 #include "../../include/graph_generator/graph_generators/ploig.hpp"
 
 namespace wlplan::graph_generator {
-  std::shared_ptr<GraphGenerator> init_feature_generator(const std::string &name,
-                                                         const planning::Domain &domain) {
+  std::shared_ptr<GraphGenerator>
+  init_feature_generator(const std::string &name,
+                         const std::shared_ptr<const planning::Domain> &domain) {
     std::shared_ptr<GraphGenerator> graph_generator;
     if (name == "ilg") {
       graph_generator = std::make_shared<ILGGenerator>(domain, false);
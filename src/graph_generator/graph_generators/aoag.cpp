@@ -1,7 +1,7 @@
 #include "../../../include/graph_generator/graph_generators/aoag.hpp"
 
 namespace wlplan::graph_generator {
-  AOAGGenerator::AOAGGenerator(const planning::Domain &domain,
+  AOAGGenerator::AOAGGenerator(const std::shared_ptr<const planning::Domain> &domain,
                                const bool differentiate_constant_objects)
       : ILGGenerator(domain, differentiate_constant_objects, "AOAGGenerator") {
 
@@ -13,8 +13,8 @@ namespace wlplan::graph_generator {
     }
     colour++;
 
-    for (size_t i = 0; i < domain.schemata.size(); i++) {
-      std::string schema_name = domain.schemata[i].name;
+    for (size_t i = 0; i < domain->schemata.size(); i++) {
+      std::string schema_name = domain->schemata[i].name;
       colour_to_description[colour] = schema_name;
       schema_to_graph_colour[schema_name] = colour;
       colour++;
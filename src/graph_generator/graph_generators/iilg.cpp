@@ -1,7 +1,8 @@
 #include "../../../include/graph_generator/graph_generators/iilg.hpp"
 
 namespace wlplan::graph_generator {
-  IILGGenerator::IILGGenerator(const planning::Domain &domain) : ILGGenerator(domain, true) {}
+  IILGGenerator::IILGGenerator(const std::shared_ptr<const planning::Domain> &domain)
+      : ILGGenerator(domain, true) {}
 
   void IILGGenerator::set_problem(const planning::Problem &problem) {
     ILGGenerator::set_problem(problem);
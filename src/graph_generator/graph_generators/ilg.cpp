@@ -5,19 +5,19 @@ char const *fact_description_name[] = {ILG_FACT_DESCRIPTIONS};
 #undef X
 
 namespace wlplan::graph_generator {
-  ILGGenerator::ILGGenerator(const planning::Domain &domain,
+  ILGGenerator::ILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
                              const bool differentiate_constant_objects)
       : ILGGenerator(domain, differentiate_constant_objects, "ILGGenerator") {}
 
-  ILGGenerator::ILGGenerator(const planning::Domain &domain,
+  ILGGenerator::ILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
                              const bool differentiate_constant_objects,
                              const std::string &derived_graph_generator_name)
       : GraphGenerator(domain, differentiate_constant_objects, derived_graph_generator_name) {
     // add predicate colours
-    for (size_t i = 0; i < domain.predicates.size(); i++) {
+    for (size_t i = 0; i < domain->predicates.size(); i++) {
       for (int j = 0; j < (int)ILGFactDescription::_LAST; j++) {
         int colour = fact_colour(i, (ILGFactDescription)j);
-        std::string desc = domain.predicates[i].name + " " + fact_description_name[j];
+        std::string desc = domain->predicates[i].name + " " + fact_description_name[j];
         colour_to_description[colour] = desc;
       }
     }
@@ -35,7 +35,7 @@ namespace wlplan::graph_generator {
 
     // add constant object nodes
     for (size_t i = 0; i < problem.get_constant_objects().size(); i++) {
-      std::string node = domain.constant_objects[i];
+      std::string node = domain->constant_objects[i];
       if (differentiate_constant_objects) {
         colour = -(i + 1);
       } else {
@@ -78,6 +78,27 @@ namespace wlplan::graph_generator {
       }
     }
 
+    /* index nodes by symbol ids */
+    packed_symbol_table = problem.get_symbol_table();
+    const planning::SymbolTable &symbols = *packed_symbol_table;
+    object_id_to_node = std::vector<int>(symbols.get_n_objects());
+    for (int i = 0; i < symbols.get_n_objects(); i++) {
+      object_id_to_node[i] = graph.get_node_index(symbols.get_object(i));
+    }
+    auto index_goals = [&](const std::vector<planning::Atom> &goals,
+                           std::unordered_map<std::vector<int>, int, utils::IntVectorHash> &index) {
+      index.clear();
+      planning::PackedAtoms packed_goals = symbols.pack(goals);
+      for (size_t i = 0; i < goals.size(); i++) {
+        const int *objects = packed_goals.get_objects(i);
+        std::vector<int> key = {packed_goals.predicates[i]};
+        key.insert(key.end(), objects, objects + packed_goals.get_arity(i));
+        index[key] = graph.get_node_index(goals[i].to_string());
+      }
+    };
+    index_goals(problem.get_positive_goals(), packed_positive_goal_to_node);
+    index_goals(problem.get_negative_goals(), packed_negative_goal_to_node);
+
     /* set pointer */
     base_graph = std::make_shared<Graph>(graph);
     n_edges_added = std::vector<int>(base_graph->nodes.size(), 0);
@@ -86,6 +107,13 @@ namespace wlplan::graph_generator {
   std::shared_ptr<Graph> ILGGenerator::modify_graph_from_state(const planning::State &state,
                                                                const std::shared_ptr<Graph> graph,
                                                                bool store_changes) {
+    if (state.is_packed() && state.symbol_table != packed_symbol_table) {
+      // ids index the symbols of the problem that is set
+      if (problem == nullptr || !(*state.symbol_table == *problem->get_symbol_table())) {
+        throw std::runtime_error("Packed state was built from the symbols of another problem");
+      }
+      packed_symbol_table = state.symbol_table;
+    }
     if (store_changes) {
       n_nodes_added = 0;
       std::fill(n_edges_added.begin(), n_edges_added.end(), 0);
@@ -98,19 +126,56 @@ namespace wlplan::graph_generator {
 
     int atom_node, object_node, pred_idx;
     std::string atom_node_str;
+    std::vector<int> key, object_nodes;
+
+    for (size_t i = 0; i < state.get_n_atoms(); i++) {
+      int pos_goal_node = -1, neg_goal_node = -1;
+      object_nodes.clear();
+      if (state.is_packed()) {
+        // packed atoms are looked up by ids without constructing strings
+        const planning::PackedAtoms &atoms = state.packed_atoms;
+        const int *objects = atoms.get_objects(i);
+        pred_idx = atoms.predicates[i];
+        key.assign(1, pred_idx);
+        key.insert(key.end(), objects, objects + atoms.get_arity(i));
+        auto pos_it = packed_positive_goal_to_node.find(key);
+        auto neg_it = packed_negative_goal_to_node.find(key);
+        if (pos_it != packed_positive_goal_to_node.end()) {
+          pos_goal_node = pos_it->second;
+        } else if (neg_it != packed_negative_goal_to_node.end()) {
+          neg_goal_node = neg_it->second;
+        } else {
+          for (int r = 0; r < atoms.get_arity(i); r++) {
+            object_nodes.push_back(object_id_to_node[objects[r]]);
+          }
+          // node names are only stored in copies of the base graph
+          atom_node_str = store_changes ? "" : state.symbol_table->unpack(atoms, i).to_string();
+        }
+      } else {
+        const auto &atom = state.atoms[i];
+        atom_node_str = atom->to_string();
+        pred_idx = domain->predicate_to_colour.at(atom->predicate->name);
+        if (positive_goal_names.count(atom_node_str)) {
+          pos_goal_node = graph->get_node_index(atom_node_str);
+        } else if (negative_goal_names.count(atom_node_str)) {
+          neg_goal_node = graph->get_node_index(atom_node_str);
+        } else {
+          // object nodes should never be needed to be added
+          for (const planning::Object &object : atom->objects) {
+            object_nodes.push_back(graph->get_node_index(object));
+          }
+        }
+      }
 
-    for (const auto &atom : state.atoms) {
-      atom_node_str = atom->to_string();
-      pred_idx = domain.predicate_to_colour.at(atom->predicate->name);
-      if (positive_goal_names.count(atom_node_str)) {
-        atom_node = graph->get_node_index(atom_node_str);
+      if (pos_goal_node != -1) {
+        atom_node = pos_goal_node;
         graph->change_node_colour(atom_node, fact_colour(pred_idx, ILGFactDescription::T_POS_GOAL));
         if (store_changes) {
           pos_goal_changed.push_back(atom_node);
           pos_goal_changed_pred.push_back(pred_idx);
         }
-      } else if (negative_goal_names.count(atom_node_str)) {
-        atom_node = graph->get_node_index(atom_node_str);
+      } else if (neg_goal_node != -1) {
+        atom_node = neg_goal_node;
         graph->change_node_colour(atom_node, fact_colour(pred_idx, ILGFactDescription::T_NEG_GOAL));
         if (store_changes) {
           neg_goal_changed.push_back(atom_node);
@@ -123,9 +188,8 @@ namespace wlplan::graph_generator {
           n_nodes_added++;
         }
 
-        for (size_t r = 0; r < atom->objects.size(); r++) {
-          // object nodes should never be needed to be added
-          object_node = graph->get_node_index(atom->objects[r]);
+        for (size_t r = 0; r < object_nodes.size(); r++) {
+          object_node = object_nodes[r];
           graph->add_edge(atom_node, r, object_node);
           graph->add_edge(object_node, r, atom_node);
           if (store_changes) {
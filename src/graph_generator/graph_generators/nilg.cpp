@@ -1,13 +1,14 @@
 #include "../../../include/graph_generator/graph_generators/nilg.hpp"
 
 namespace wlplan::graph_generator {
-  NILGGenerator::NILGGenerator(const planning::Domain &domain, bool differentiate_constant_objects)
+  NILGGenerator::NILGGenerator(const std::shared_ptr<const planning::Domain> &domain,
+                               bool differentiate_constant_objects)
       : ILGGenerator(domain, differentiate_constant_objects) {
 
     // add function colours
-    for (size_t i = 0; i < domain.functions.size(); i++) {
+    for (size_t i = 0; i < domain->functions.size(); i++) {
       int colour = colour_to_description.rbegin()->first + 1;  // keys sorted in ascending order
-      std::string function_name = domain.functions[i].name;
+      std::string function_name = domain->functions[i].name;
       colour_to_description[colour] = function_name;
       fluent_to_colour[function_name] = colour;
     }
@@ -32,14 +33,15 @@ namespace wlplan::graph_generator {
     Graph graph = *base_graph;
 
     // add fluents
-    std::vector<planning::Fluent> fluents = problem.get_fluents();
-    std::vector<double> fluent_values = problem.get_fluent_values();
+    const std::vector<planning::Fluent> &fluents = problem.get_fluents();
+    const std::vector<double> &fluent_values = problem.get_fluent_values();
+    fluent_nodes = std::vector<int>(fluents.size());
     for (size_t i = 0; i < fluents.size(); i++) {
       // add nodes
       planning::Fluent fluent = fluents[i];
       std::string fluent_node = fluent.to_string();
       int colour = fluent_to_colour[fluent.function->name];
-      graph.add_node(fluent_node, colour, fluent_values[i]);
+      fluent_nodes[i] = graph.add_node(fluent_node, colour, fluent_values[i]);
 
       // add edges
       for (size_t r = 0; r < fluent.objects.size(); r++) {
@@ -50,7 +52,9 @@ namespace wlplan::graph_generator {
     }
 
     // add numeric goals
-    std::vector<planning::NumericCondition> numeric_goals = problem.get_numeric_goals();
+    numeric_goals = problem.get_numeric_goals();
+    numeric_goal_nodes = std::vector<int>(numeric_goals.size());
+    fluent_to_numeric_goals = std::vector<std::vector<int>>(fluents.size());
     for (size_t i = 0; i < numeric_goals.size(); i++) {
       // add nodes
       std::string goal_node = "_numeric_goal_" + std::to_string(i);
@@ -59,15 +63,21 @@ namespace wlplan::graph_generator {
       // not matter what we initialise it to.
       int colour = 0;
       double value = 0;
-      graph.add_node(goal_node, colour, value);
+      numeric_goal_nodes[i] = graph.add_node(goal_node, colour, value);
 
       // add edges
       for (int fluent_id : goal.get_fluent_ids()) {
         std::string fluent_node = fluents[fluent_id].to_string();
         graph.add_edge(goal_node, -1, fluent_node);
         graph.add_edge(fluent_node, -1, goal_node);
+        std::vector<int> &fluent_goals = fluent_to_numeric_goals[fluent_id];
+        if (fluent_goals.empty() || fluent_goals.back() != (int)i) {
+          fluent_goals.push_back(i);
+        }
       }
     }
+    base_fluent_values = fluent_values;
+    base_numeric_goals_evaluated = false;
 
     // set pointer
     base_graph = std::make_shared<Graph>(graph);
@@ -76,25 +86,44 @@ namespace wlplan::graph_generator {
 
   std::shared_ptr<Graph>
   NILGGenerator::modify_graph_from_numerics(const planning::State &state,
-                                            const std::shared_ptr<Graph> graph) {
-    std::vector<planning::Fluent> fluents = problem->get_fluents();
-    std::vector<double> fluent_values = state.values;
-    for (size_t i = 0; i < fluents.size(); i++) {
-      std::string fluent_node = fluents[i].to_string();
-      int fluent_node_i = graph->get_node_index(fluent_node);
-      graph->change_node_value(fluent_node_i, fluent_values[i]);
+                                            const std::shared_ptr<Graph> graph,
+                                            bool store_changes) {
+    const std::vector<double> &fluent_values = state.values;
+    if (fluent_values.size() != fluent_nodes.size()) {
+      throw std::runtime_error("State has " + std::to_string(fluent_values.size()) +
+                               " fluent values but the problem has " +
+                               std::to_string(fluent_nodes.size()) + " fluents");
+    }
+
+    // goals are evaluated once even if several of their fluents change
+    std::vector<int> changed_goals;
+    std::vector<bool> is_changed_goal(numeric_goals.size(), !base_numeric_goals_evaluated);
+    if (!base_numeric_goals_evaluated) {
+      for (size_t i = 0; i < numeric_goals.size(); i++) {
+        changed_goals.push_back(i);
+      }
+    }
+    for (size_t i = 0; i < fluent_nodes.size(); i++) {
+      if (fluent_values[i] == base_fluent_values[i]) {
+        continue;
+      }
+      graph->change_node_value(fluent_nodes[i], fluent_values[i]);
+      for (const int goal : fluent_to_numeric_goals[i]) {
+        if (!is_changed_goal[goal]) {
+          is_changed_goal[goal] = true;
+          changed_goals.push_back(goal);
+        }
+      }
     }
 
     std::pair<bool, double> goal_eval;
-    std::vector<planning::NumericCondition> num_goals = problem->get_numeric_goals();
     int goal_colour, goal_node_i;
-    for (size_t i = 0; i < num_goals.size(); i++) {
-      std::string goal_node = "_numeric_goal_" + std::to_string(i);
-      goal_node_i = graph->get_node_index(goal_node);
-      goal_eval = num_goals[i].evaluate_formula_and_error(state.values);
+    for (const int i : changed_goals) {
+      goal_node_i = numeric_goal_nodes[i];
+      goal_eval = numeric_goals[i].evaluate_formula_and_error(fluent_values);
       graph->change_node_value(goal_node_i, goal_eval.second);
 
-      switch (num_goals[i].get_comparator_type()) {
+      switch (numeric_goals[i].get_comparator_type()) {
       case planning::ComparatorType::GreaterThan:
         goal_colour = goal_eval.first ? ACHIEVED_GT_GOAL : UNACHIEVED_GT_GOAL;
         break;
@@ -108,18 +137,23 @@ namespace wlplan::graph_generator {
       graph->change_node_colour(goal_node_i, goal_colour);
     }
 
+    if (store_changes) {
+      base_fluent_values = fluent_values;
+      base_numeric_goals_evaluated = true;
+    }
+
     return graph;
   }
 
   std::shared_ptr<Graph> NILGGenerator::to_graph(const planning::State &state) {
     std::shared_ptr<Graph> graph = ILGGenerator::to_graph(state);
-    graph = modify_graph_from_numerics(state, graph);
+    graph = modify_graph_from_numerics(state, graph, false);
     return graph;
   }
 
   std::shared_ptr<Graph> NILGGenerator::to_graph_opt(const planning::State &state) {
     base_graph = ILGGenerator::to_graph_opt(state);
-    base_graph = modify_graph_from_numerics(state, base_graph);
+    base_graph = modify_graph_from_numerics(state, base_graph, true);
     return base_graph;
   }
 }  // namespace wlplan::graph_generator
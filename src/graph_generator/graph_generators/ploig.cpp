@@ -1,14 +1,14 @@
 #include "../../../include/graph_generator/graph_generators/ploig.hpp"
 
 namespace wlplan::graph_generator {
-  PLOIGGenerator::PLOIGGenerator(const planning::Domain &domain,
+  PLOIGGenerator::PLOIGGenerator(const std::shared_ptr<const planning::Domain> &domain,
                                  const bool differentiate_constant_objects)
       : GraphGenerator(domain, differentiate_constant_objects, "PLOIGGenerator") {
     // Note that there are edge colours here.
     // The only node (object) colours are already handled in GraphGenerator.
     n_relations = 0;
     std::string desc;
-    for (const auto &predicate : domain.predicates) {
+    for (const auto &predicate : domain->predicates) {
       std::map<std::pair<int, int>, int> ag;
       std::map<std::pair<int, int>, int> ug;
       std::map<std::pair<int, int>, int> ap;
@@ -70,7 +70,7 @@ namespace wlplan::graph_generator {
 
     // add constant object nodes
     for (size_t i = 0; i < problem.get_constant_objects().size(); i++) {
-      std::string node = domain.constant_objects[i];
+      std::string node = domain->constant_objects[i];
       if (differentiate_constant_objects) {
         colour = -(i + 1);
       } else {
@@ -104,7 +104,7 @@ namespace wlplan::graph_generator {
     std::vector<std::shared_ptr<planning::Atom>> ug;
     std::vector<std::shared_ptr<planning::Atom>> ag;
     std::vector<std::shared_ptr<planning::Atom>> ap;
-    for (const auto &atom : state.atoms) {
+    for (const auto &atom : state.get_atom_pointers()) {
       std::string atom_name = atom->to_string();
       if (positive_goal_names.count(atom_name)) {
         unachieved_goals.erase(atom_name);
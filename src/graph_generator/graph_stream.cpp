@@ -0,0 +1,50 @@
+#include "../../include/graph_generator/graph_stream.hpp"
+
+namespace wlplan::graph_generator {
+  GraphStream::GraphStream(GraphGenerator &graph_generator, const data::DomainDataset &dataset)
+      : graph_generator(graph_generator),
+        dataset(dataset),
+        problem_i(0),
+        state_i(0),
+        problem_set(false),
+        n_produced(0) {}
+
+  std::shared_ptr<Graph> GraphStream::next() {
+    const std::vector<data::ProblemDataset> &data = dataset.data;
+    while (problem_i < data.size()) {
+      const auto &d = data.at(problem_i);
+      if (state_i >= d.states.size()) {
+        problem_i++;
+        state_i = 0;
+        problem_set = false;
+        continue;
+      }
+      if (!problem_set) {
+        graph_generator.set_problem(d.problem);
+        problem_set = true;
+      }
+
+      planning::ActionPointers action_pointers;
+      for (const auto &action : d.actions.at(state_i)) {
+        action_pointers.push_back(std::make_shared<planning::Action>(action));
+      }
+      std::shared_ptr<Graph> graph = graph_generator.to_graph(d.states.at(state_i), action_pointers);
+      state_i++;
+      n_produced++;
+      return graph;
+    }
+    return nullptr;
+  }
+
+  std::vector<Graph> GraphStream::next_chunk(size_t max_graphs) {
+    std::vector<Graph> graphs;
+    while (graphs.size() < max_graphs) {
+      std::shared_ptr<Graph> graph = next();
+      if (graph == nullptr) {
+        break;
+      }
+      graphs.push_back(*graph);
+    }
+    return graphs;
+  }
+}  // namespace wlplan::graph_generator
@@ -1,3 +1,4 @@
+#include "../include/data/columnar_dataset.hpp"
 #include "../include/data/dataset.hpp"
 #include "../include/feature_generator/feature_generators/ccwl.hpp"
 #include "../include/feature_generator/feature_generators/ccwla.hpp"
@@ -8,6 +9,7 @@
 #include "../include/feature_generator/feature_generators/wl.hpp"
 #include "../include/feature_generator/features.hpp"
 #include "../include/feature_generator/pruning_options.hpp"
+#include "../include/feature_generator/refinement_options.hpp"
 #include "../include/graph_generator/graph_generators/aoag.hpp"
 #include "../include/graph_generator/graph_generators/iilg.hpp"
 #include "../include/graph_generator/graph_generators/ilg.hpp"
@@ -20,23 +22,48 @@
 #include "../include/planning/numeric_condition.hpp"
 #include "../include/planning/numeric_expression.hpp"
 #include "../include/planning/object.hpp"
+#include "../include/planning/pddl_parser.hpp"
 #include "../include/planning/predicate.hpp"
 #include "../include/planning/problem.hpp"
 #include "../include/planning/schema.hpp"
+#include "../include/planning/symbol_table.hpp"
 #include "../include/serialise.hpp"
 #include "../include/utils/exceptions.hpp"
 
 #include <pybind11/functional.h>
+#include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/typing.h>
 
+#include <algorithm>
+
 #define STRINGIFY(x) #x
 #define MACRO_STRINGIFY(x) STRINGIFY(x)
 
 namespace py = pybind11;
 using namespace py::literals;
 
+// contiguous numpy arrays, converted only if their dtype or layout differ
+using IntArray = py::array_t<int, py::array::c_style | py::array::forcecast>;
+using DoubleArray = py::array_t<double, py::array::c_style | py::array::forcecast>;
+
+// Offsets index the next array, so besides their first and last entries checked by the caller
+// they must be non-decreasing to stay in range
+void check_non_decreasing(const IntArray &offsets, const std::string &name) {
+  if (!std::is_sorted(offsets.data(), offsets.data() + offsets.size())) {
+    throw std::runtime_error(name + " must be non-decreasing");
+  }
+}
+
+// __reduce_ex__ pickling the binary form of T, which is read back by a function of a submodule
+template <typename T>
+auto binary_reduce_ex(const char *module_name, const char *from_buffer) {
+  return [module_name, from_buffer](const T &self, int protocol) {
+    return __reduce_ex__(self, protocol, py::module_::import(module_name).attr(from_buffer));
+  };
+}
+
 PYBIND11_MODULE(_wlplan, m) {
   m.doc() = "WLPlan: WL Features for PDDL Planning";
 
@@ -316,14 +343,63 @@ PYBIND11_MODULE(_wlplan, m) {
                     std::shared_ptr<wlplan::planning::NumericExpression> &>(),
            "comparator_type"_a,
            "expression"_a)
+      .def_property_readonly("comparator_type",
+                             &wlplan::planning::NumericCondition::get_comparator_type)
+      .def_property_readonly("expression", &wlplan::planning::NumericCondition::get_expression)
       .def("evaluate_formula", &wlplan::planning::NumericCondition::evaluate_formula, "values"_a)
       .def("evaluate_error", &wlplan::planning::NumericCondition::evaluate_error, "values"_a)
       .def("evaluate_formula_and_error",
            &wlplan::planning::NumericCondition::evaluate_formula_and_error,
            "values"_a)
+      .def(
+          "evaluate_batch",
+          [](const wlplan::planning::NumericCondition &condition, const DoubleArray &values) {
+            if (values.ndim() != 2) {
+              throw std::runtime_error("values must be a matrix of fluents by states");
+            }
+            const size_t n_states = values.shape(1);
+            std::vector<double> values_vec(values.data(), values.data() + values.size());
+            std::vector<bool> formulas;
+            std::vector<double> errors;
+            condition.evaluate_batch(values_vec, n_states, formulas, errors);
+
+            py::array_t<bool> formulas_array(n_states);
+            py::array_t<double> errors_array(n_states);
+            auto formulas_ptr = formulas_array.mutable_unchecked<1>();
+            auto errors_ptr = errors_array.mutable_unchecked<1>();
+            for (size_t i = 0; i < n_states; i++) {
+              formulas_ptr(i) = formulas[i];
+              errors_ptr(i) = errors[i];
+            }
+            return py::make_tuple(formulas_array, errors_array);
+          },
+          "values"_a,
+          R"(Evaluates the condition on many states at once.
+
+Parameters
+----------
+    values : numpy.ndarray[float]
+        Fluent values as a matrix with one row per fluent and one column per state.
+
+Returns
+-------
+    formulas : numpy.ndarray[bool]
+        Whether the condition holds in each state.
+
+    errors : numpy.ndarray[float]
+        Error of the condition in each state.
+)")
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::planning::NumericCondition>("_wlplan.planning",
+                                                                "_numeric_condition_from_buffer"),
+           "protocol"_a)
       .def(py::pickle(&__getstate__<wlplan::planning::NumericCondition>,
                       &__setstate__<wlplan::planning::NumericCondition>));
 
+  planning_m.def("_numeric_condition_from_buffer",
+                 &__from_buffer__<wlplan::planning::NumericCondition>,
+                 "buffer"_a);
+
   // Problem
   py::class_<wlplan::planning::Problem>(planning_m,
                                         "Problem",
@@ -401,11 +477,26 @@ PYBIND11_MODULE(_wlplan, m) {
       .def_property_readonly("positive_goals", &wlplan::planning::Problem::get_positive_goals)
       .def_property_readonly("negative_goals", &wlplan::planning::Problem::get_negative_goals)
       .def_property_readonly("numeric_goals", &wlplan::planning::Problem::get_numeric_goals)
+      .def_property_readonly("predicate_to_id", &wlplan::planning::Problem::get_predicate_to_id)
+      .def_property_readonly("object_to_id", &wlplan::planning::Problem::get_object_to_id)
       .def("__repr__", &wlplan::planning::Problem::to_string)
       .def("__eq__", &wlplan::planning::Problem::operator==)
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::planning::Problem>("_wlplan.planning", "_problem_from_buffer"),
+           "protocol"_a)
       .def(py::pickle(&__getstate__<wlplan::planning::Problem>,
                       &__setstate__<wlplan::planning::Problem>));
 
+  planning_m.def("_problem_from_buffer", &__from_buffer__<wlplan::planning::Problem>, "buffer"_a);
+
+  // SymbolTable
+  py::class_<wlplan::planning::SymbolTable, std::shared_ptr<wlplan::planning::SymbolTable>>(
+      planning_m,
+      "_SymbolTable",
+      "Predicate and object ids shared by the pickled states of a problem.")
+      .def(py::pickle(&__getstate__<wlplan::planning::SymbolTable>,
+                      &__setstate__<wlplan::planning::SymbolTable>));
+
   // State
   py::class_<wlplan::planning::State>(planning_m,
                                       "State",
@@ -416,19 +507,275 @@ PYBIND11_MODULE(_wlplan, m) {
 
     values : list[float], optional
         List of values for fluents defined in the problem.
+
+A state can also be constructed from integer arrays relative to the symbols of a problem, without
+constructing Atom objects. Arrays of dtype int32 are read without conversion.
+
+Parameters
+----------
+    problem : Problem
+        Problem whose `predicate_to_id` and `object_to_id` define the ids.
+
+    predicates : numpy.ndarray[int]
+        Predicate id of each atom.
+
+    objects : numpy.ndarray[int]
+        Object ids of all atoms, concatenated.
+
+    offsets : numpy.ndarray[int]
+        Offsets of the objects of each atom, with one more entry than `predicates`. The objects of
+        atom i are objects[offsets[i]:offsets[i + 1]].
+
+    values : list[float], optional
+        List of values for fluents defined in the problem.
 )")
       .def(py::init<const std::vector<wlplan::planning::Atom> &>(), "atoms"_a)
       .def(py::init<const std::vector<wlplan::planning::Atom> &, const std::vector<double> &>(),
            "atoms"_a,
            "values"_a)
+      .def(py::init([](const wlplan::planning::Problem &problem,
+                       const IntArray &predicates,
+                       const IntArray &objects,
+                       const IntArray &offsets,
+                       const std::vector<double> &values) {
+             if (offsets.size() != predicates.size() + 1 || offsets.at(0) != 0 ||
+                 offsets.at(predicates.size()) != objects.size()) {
+               throw std::runtime_error("offsets need one more entry than predicates, starting at "
+                                        "0 and ending at the number of objects");
+             }
+             wlplan::planning::PackedAtoms atoms(
+                 predicates.data(), objects.data(), offsets.data(), predicates.size());
+             problem.get_symbol_table()->check_packed(atoms);
+             return wlplan::planning::State(problem.get_symbol_table(), atoms, values);
+           }),
+           "problem"_a,
+           "predicates"_a,
+           "objects"_a,
+           "offsets"_a,
+           "values"_a = std::vector<double>())
+      .def_property_readonly("is_packed", &wlplan::planning::State::is_packed)
       .def_property_readonly("atoms", &wlplan::planning::State::get_atoms)
       .def_readonly("values", &wlplan::planning::State::values)
+      .def("successor",
+           py::overload_cast<const std::vector<wlplan::planning::Atom> &,
+                             const std::vector<wlplan::planning::Atom> &>(
+               &wlplan::planning::State::successor, py::const_),
+           "add_atoms"_a,
+           "delete_atoms"_a,
+           R"(Returns the state after deleting and then adding atoms, with an incrementally updated
+hash. Values are kept.
+
+Parameters
+----------
+    add_atoms : list[Atom]
+        Atoms to add.
+
+    delete_atoms : list[Atom]
+        Atoms to delete.
+
+Returns
+-------
+    state : State
+)")
+      .def("successor",
+           py::overload_cast<const std::vector<wlplan::planning::Atom> &,
+                             const std::vector<wlplan::planning::Atom> &,
+                             const std::vector<double> &>(&wlplan::planning::State::successor,
+                                                          py::const_),
+           "add_atoms"_a,
+           "delete_atoms"_a,
+           "values"_a,
+           R"(Returns the state after deleting and then adding atoms, with new fluent values.
+
+Parameters
+----------
+    add_atoms : list[Atom]
+        Atoms to add.
+
+    delete_atoms : list[Atom]
+        Atoms to delete.
+
+    values : list[float]
+        Values of fluents of the successor state.
+
+Returns
+-------
+    state : State
+)")
       .def("__repr__", &::wlplan::planning::State::to_string)
       .def("__eq__", &::wlplan::planning::State::operator==)
       .def("__hash__", &::wlplan::planning::State::hash)
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::planning::State>("_wlplan.planning", "_state_from_buffer"),
+           "protocol"_a)
       .def(py::pickle(&__getstate__<wlplan::planning::State>,
                       &__setstate__<wlplan::planning::State>));
 
+  planning_m.def("_state_from_buffer", &__state_from_buffer__, "symbol_table"_a, "buffer"_a);
+
+  planning_m.def(
+      "states_from_arrays",
+      [](const wlplan::planning::Problem &problem,
+         const IntArray &predicates,
+         const IntArray &objects,
+         const IntArray &atom_offsets,
+         const IntArray &state_offsets,
+         const std::optional<DoubleArray> &values) {
+        if (state_offsets.size() == 0) {
+          throw std::runtime_error("state_offsets need one more entry than states");
+        }
+        const size_t n_states = state_offsets.size() - 1;
+        if (state_offsets.at(0) != 0 ||
+            state_offsets.at(n_states) != predicates.size()) {
+          throw std::runtime_error("state_offsets need one more entry than states, starting at 0 "
+                                   "and ending at the number of atoms");
+        }
+        if (atom_offsets.size() != predicates.size() + 1 || atom_offsets.at(0) != 0 ||
+            atom_offsets.at(predicates.size()) != objects.size()) {
+          throw std::runtime_error("atom_offsets need one more entry than atoms, starting at 0 "
+                                   "and ending at the number of objects");
+        }
+        check_non_decreasing(state_offsets, "state_offsets");
+        check_non_decreasing(atom_offsets, "atom_offsets");
+        size_t n_values = 0;
+        if (values.has_value()) {
+          if (values->ndim() != 2 || (size_t)values->shape(0) != n_states) {
+            throw std::runtime_error("values need one row per state");
+          }
+          n_values = values->shape(1);
+        }
+
+        const std::shared_ptr<const wlplan::planning::SymbolTable> symbol_table =
+            problem.get_symbol_table();
+        const int *state_offsets_ptr = state_offsets.data();
+        const int *predicates_ptr = predicates.data();
+        const int *objects_ptr = objects.data();
+        const int *atom_offsets_ptr = atom_offsets.data();
+        const double *values_ptr = values.has_value() ? values->data() : nullptr;
+        std::vector<wlplan::planning::State> states;
+        states.reserve(n_states);
+        {
+          // arrays are only read from here, so other Python threads can run
+          py::gil_scoped_release release;
+          for (size_t i = 0; i < n_states; i++) {
+            const int start = state_offsets_ptr[i];
+            const int end = state_offsets_ptr[i + 1];
+            wlplan::planning::PackedAtoms atoms(
+                predicates_ptr + start, objects_ptr, atom_offsets_ptr + start, end - start);
+            symbol_table->check_packed(atoms);
+            std::vector<double> state_values;
+            if (values_ptr != nullptr) {
+              state_values.assign(values_ptr + i * n_values, values_ptr + (i + 1) * n_values);
+            }
+            states.push_back(wlplan::planning::State(symbol_table, atoms, state_values));
+          }
+        }
+        return states;
+      },
+      "problem"_a,
+      "predicates"_a,
+      "objects"_a,
+      "atom_offsets"_a,
+      "state_offsets"_a,
+      "values"_a = py::none(),
+      R"(Constructs many states of a problem at once from integer arrays, as in the array
+constructor of State.
+
+Parameters
+----------
+    problem : Problem
+        Problem whose `predicate_to_id` and `object_to_id` define the ids.
+
+    predicates : numpy.ndarray[int]
+        Predicate id of each atom of all states, concatenated.
+
+    objects : numpy.ndarray[int]
+        Object ids of all atoms, concatenated.
+
+    atom_offsets : numpy.ndarray[int]
+        Offsets of the objects of each atom, with one more entry than `predicates`.
+
+    state_offsets : numpy.ndarray[int]
+        Offsets of the atoms of each state, with one more entry than the number of states. The
+        atoms of state i are predicates[state_offsets[i]:state_offsets[i + 1]].
+
+    values : numpy.ndarray[float], optional
+        Fluent values of each state as a matrix with one row per state.
+
+Returns
+-------
+    states : list[State]
+)");
+
+  planning_m.def("parse_domain",
+                 &wlplan::planning::parse_domain,
+                 "domain_path"_a,
+                 "domain_name"_a = "",
+                 "keep_statics"_a = true,
+                 R"(Parses a PDDL domain file natively. Types are ignored.
+
+Parameters
+----------
+    domain_path : str
+        Path to the domain file.
+
+    domain_name : str, default=""
+        Name of the domain, or the name in the file if empty.
+
+    keep_statics : bool, default=True
+        Whether to keep static predicates. Otherwise only predicates occurring in action effects
+        are kept.
+)");
+
+  planning_m.def("parse_problem",
+                 &wlplan::planning::parse_problem,
+                 "domain_path"_a,
+                 "problem_path"_a,
+                 "keep_statics"_a = true,
+                 R"(Parses a PDDL domain and problem file natively. Only initial fluent values are
+read from the initial state.
+
+Parameters
+----------
+    domain_path : str
+        Path to the domain file.
+
+    problem_path : str
+        Path to the problem file.
+
+    keep_statics : bool, default=True
+        Whether to keep static predicates in the parsed domain.
+)");
+
+  planning_m.def("parse_problems",
+                 &wlplan::planning::parse_problems,
+                 "domain_path"_a,
+                 "problem_paths"_a,
+                 "keep_statics"_a = true,
+                 "n_threads"_a = 0,
+                 py::call_guard<py::gil_scoped_release>(),
+                 R"(Parses many PDDL problem files of a domain in parallel, without holding the GIL.
+
+Parameters
+----------
+    domain_path : str
+        Path to the domain file, which is parsed once.
+
+    problem_paths : list[str]
+        Paths to the problem files.
+
+    keep_statics : bool, default=True
+        Whether to keep static predicates in the parsed domain.
+
+    n_threads : int, default=0
+        Number of threads, or one per core if not positive.
+
+Returns
+-------
+    problems : list[Problem]
+        Problems in the order of `problem_paths`.
+)");
+
   //////////////////////////////////////////////////////////////////////////////
   // Data
   //////////////////////////////////////////////////////////////////////////////
@@ -455,9 +802,17 @@ Parameters
            "data"_a)
       .def_readonly("domain", &wlplan::data::DomainDataset::domain)
       .def_readonly("data", &wlplan::data::DomainDataset::data)
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::data::DomainDataset>("_wlplan.data",
+                                                         "_domain_dataset_from_buffer"),
+           "protocol"_a)
       .def(py::pickle(&__getstate__<wlplan::data::DomainDataset>,
                       &__setstate__<wlplan::data::DomainDataset>));
 
+  data_m.def("_domain_dataset_from_buffer",
+             &__from_buffer__<wlplan::data::DomainDataset>,
+             "buffer"_a);
+
   // ProblemDataset
   py::class_<wlplan::data::ProblemDataset>(data_m,
                                            "ProblemDataset",
@@ -489,9 +844,48 @@ Parameters
       .def_readonly("problem", &wlplan::data::ProblemDataset::problem)
       .def_readonly("states", &wlplan::data::ProblemDataset::states)
       .def_readonly("actions", &wlplan::data::ProblemDataset::actions)
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::data::ProblemDataset>("_wlplan.data",
+                                                          "_problem_dataset_from_buffer"),
+           "protocol"_a)
       .def(py::pickle(&__getstate__<wlplan::data::ProblemDataset>,
                       &__setstate__<wlplan::data::ProblemDataset>));
 
+  data_m.def("_problem_dataset_from_buffer",
+             &__from_buffer__<wlplan::data::ProblemDataset>,
+             "buffer"_a);
+
+  // ColumnarDataset
+  py::class_<wlplan::data::ColumnarDataset>(data_m,
+                                            "ColumnarDataset",
+                                            R"(Compact form of a DomainDataset.
+
+Atoms and actions of each problem are interned into tables of ids, and states are stored as flat
+arrays of atom ids that are changes from the previous state where this is smaller. The dataset
+can be saved to a binary file and loaded with mmap, after which states are only decoded when
+accessed. All states of a problem must have the same number of fluent values.
+
+Parameters
+----------
+    dataset : DomainDataset
+        Dataset to convert.
+)")
+      .def(py::init<const wlplan::data::DomainDataset &>(), "dataset"_a)
+      .def_static("load",
+                  &wlplan::data::ColumnarDataset::load,
+                  "path"_a,
+                  R"(Loads a dataset saved with `save` by memory mapping the file.)")
+      .def("save", &wlplan::data::ColumnarDataset::save, "path"_a)
+      .def_property_readonly("domain", &wlplan::data::ColumnarDataset::get_domain)
+      .def_property_readonly("n_problems", &wlplan::data::ColumnarDataset::get_n_problems)
+      .def("__len__", &wlplan::data::ColumnarDataset::get_size)
+      .def("get_problem", &wlplan::data::ColumnarDataset::get_problem, "i"_a)
+      .def("get_states", &wlplan::data::ColumnarDataset::get_states, "i"_a)
+      .def("get_state", &wlplan::data::ColumnarDataset::get_state, "i"_a, "j"_a)
+      .def("get_actions", &wlplan::data::ColumnarDataset::get_actions, "i"_a)
+      .def("get_problem_dataset", &wlplan::data::ColumnarDataset::get_problem_dataset, "i"_a)
+      .def("to_domain_dataset", &wlplan::data::ColumnarDataset::to_domain_dataset);
+
   //////////////////////////////////////////////////////////////////////////////
   // Graph
   //////////////////////////////////////////////////////////////////////////////
@@ -587,33 +981,57 @@ Methods
   // ILGGenerator
   py::class_<wlplan::graph_generator::ILGGenerator, wlplan::graph_generator::GraphGenerator>(
       graph_generator_m, "ILGGenerator")
-      .def(py::init<wlplan::planning::Domain &, bool>(),
+      .def(py::init([](const wlplan::planning::Domain &domain,
+                       bool differentiate_constant_objects) {
+             return std::make_unique<wlplan::graph_generator::ILGGenerator>(
+                 std::make_shared<const wlplan::planning::Domain>(domain),
+                 differentiate_constant_objects);
+           }),
            "domain"_a,
            "differentiate_constant_objects"_a);
 
   // IILGGenerator
   py::class_<wlplan::graph_generator::IILGGenerator, wlplan::graph_generator::GraphGenerator>(
       graph_generator_m, "IILGGenerator")
-      .def(py::init<wlplan::planning::Domain &>(), "domain"_a);
+      .def(py::init([](const wlplan::planning::Domain &domain) {
+             return std::make_unique<wlplan::graph_generator::IILGGenerator>(
+                 std::make_shared<const wlplan::planning::Domain>(domain));
+           }),
+           "domain"_a);
 
   // NILGGenerator
   py::class_<wlplan::graph_generator::NILGGenerator, wlplan::graph_generator::ILGGenerator>(
       graph_generator_m, "NILGGenerator")
-      .def(py::init<wlplan::planning::Domain &, bool>(),
+      .def(py::init([](const wlplan::planning::Domain &domain,
+                       bool differentiate_constant_objects) {
+             return std::make_unique<wlplan::graph_generator::NILGGenerator>(
+                 std::make_shared<const wlplan::planning::Domain>(domain),
+                 differentiate_constant_objects);
+           }),
            "domain"_a,
            "differentiate_constant_objects"_a);
 
   // PLOIGGenerator
   py::class_<wlplan::graph_generator::PLOIGGenerator, wlplan::graph_generator::GraphGenerator>(
       graph_generator_m, "PLOIGGenerator")
-      .def(py::init<wlplan::planning::Domain &, bool>(),
+      .def(py::init([](const wlplan::planning::Domain &domain,
+                       bool differentiate_constant_objects) {
+             return std::make_unique<wlplan::graph_generator::PLOIGGenerator>(
+                 std::make_shared<const wlplan::planning::Domain>(domain),
+                 differentiate_constant_objects);
+           }),
            "domain"_a,
            "differentiate_constant_objects"_a);
 
   // AOAGGenerator
   py::class_<wlplan::graph_generator::AOAGGenerator, wlplan::graph_generator::GraphGenerator>(
       graph_generator_m, "AOAGGenerator")
-      .def(py::init<wlplan::planning::Domain &, bool>(),
+      .def(py::init([](const wlplan::planning::Domain &domain,
+                       bool differentiate_constant_objects) {
+             return std::make_unique<wlplan::graph_generator::AOAGGenerator>(
+                 std::make_shared<const wlplan::planning::Domain>(domain),
+                 differentiate_constant_objects);
+           }),
            "domain"_a,
            "differentiate_constant_objects"_a);
 
@@ -627,16 +1045,78 @@ Methods
       .def_readonly_static("NONE", &wlplan::feature_generator::PruningOptions::NONE)
       .def_static("get_all", &wlplan::feature_generator::PruningOptions::get_all);
 
+  // RefinementOptions
+  py::class_<wlplan::feature_generator::RefinementOptions>(feature_generator_m,
+                                                           "RefinementOptions")
+      .def_readonly_static("NODE", &wlplan::feature_generator::RefinementOptions::NODE)
+      .def_readonly_static("PARTITION", &wlplan::feature_generator::RefinementOptions::PARTITION)
+      .def_static("get_all", &wlplan::feature_generator::RefinementOptions::get_all);
+
   // Features
   py::class_<wlplan::feature_generator::Features>(feature_generator_m, "Features")
       .def("collect",
-           py::overload_cast<const wlplan::data::DomainDataset>(
+           py::overload_cast<const wlplan::data::DomainDataset &>(
                &wlplan::feature_generator::Features::collect_from_dataset),
            "dataset"_a)
       .def("collect",
            py::overload_cast<const std::vector<wlplan::graph_generator::Graph> &>(
                &wlplan::feature_generator::Features::collect),
            "graphs"_a)
+      .def("extend",
+           &wlplan::feature_generator::Features::extend_from_dataset,
+           "dataset"_a,
+           R"(Refine only the graphs of a new dataset against the collected colours. Keys that were not
+seen before are appended as new colours, so existing colours keep their ids and meaning. Pruning is
+not applied to new colours. Dense weights are padded with zeros for the new features.
+
+Parameters
+----------
+    dataset : DomainDataset
+        New training data.
+
+Returns
+-------
+    list[int]
+        Ids of the new colours.
+)")
+      .def("extend", &wlplan::feature_generator::Features::extend, "graphs"_a)
+      .def("merge",
+           &wlplan::feature_generator::Features::merge,
+           "other"_a,
+           R"(Union the colours of a feature generator with the same configuration that was collected
+on other data. Colours are renumbered canonically layer by layer from the union of colour keys, so
+the result does not depend on the order of merging. Stored weights are cleared.
+
+Parameters
+----------
+    other : Features
+        Feature generator to merge into this one.
+
+Returns
+-------
+    tuple[dict[int, int], dict[int, int]]
+        Maps from the old colour ids of this and of the other generator to the merged colour ids.
+)")
+      .def("collect_problem",
+           &wlplan::feature_generator::Features::collect_problem,
+           "problem"_a,
+           "states"_a,
+           R"(Add the colours of the states of one problem. This allows collecting over a stream of
+problems without building a dataset of all of them. Call `end_collect` once after the last
+problem. Not supported with pruning.
+
+Parameters
+----------
+    problem : Problem
+        Problem of the states.
+
+    states : list[State]
+        Training states.
+)")
+      .def("end_collect",
+           &wlplan::feature_generator::Features::end_collect,
+           R"(Finish a collection over `collect_problem` calls. Layers without colours are only
+removed here, as a later problem may still add colours to them.)")
       .def("to_graphs", &wlplan::feature_generator::Features::to_graphs, "dataset"_a)
       .def("set_problem", &wlplan::feature_generator::Features::set_problem, "problem"_a)
       .def("get_string_representation",
@@ -663,6 +1143,37 @@ Methods
            py::overload_cast<const wlplan::planning::State &>(
                &wlplan::feature_generator::Features::embed_state),
            "state"_a)
+      .def("embed_problem",
+           &wlplan::feature_generator::Features::embed_problem,
+           "problem"_a,
+           "states"_a,
+           R"(Embed the states of one problem, for embedding a stream of problems chunk by chunk.
+
+Parameters
+----------
+    problem : Problem
+        Problem of the states.
+
+    states : list[State]
+        States to embed.
+
+Returns
+-------
+    list[list[float]]
+        Embeddings of the states.
+)")
+      .def("embed_sparse",
+           py::overload_cast<const wlplan::data::DomainDataset &>(
+               &wlplan::feature_generator::Features::embed_sparse_dataset),
+           "dataset"_a)
+      .def("embed_sparse",
+           py::overload_cast<const std::vector<wlplan::graph_generator::Graph> &>(
+               &wlplan::feature_generator::Features::embed_sparse_graphs),
+           "graphs"_a)
+      .def("embed_sparse",
+           py::overload_cast<const wlplan::planning::State &>(
+               &wlplan::feature_generator::Features::embed_sparse_state),
+           "state"_a)
       .def("get_n_features", &wlplan::feature_generator::Features::get_n_features)
       .def("get_n_colours", &wlplan::feature_generator::Features::get_n_colours)
       .def("get_seen_counts", &wlplan::feature_generator::Features::get_seen_counts)
@@ -677,8 +1188,59 @@ Methods
       .def("get_iterations", &wlplan::feature_generator::Features::get_iterations)
       .def("get_pruning", &wlplan::feature_generator::Features::get_pruning)
       .def("set_pruning", &wlplan::feature_generator::Features::set_pruning, "pruning"_a)
+      .def("set_hash_dim",
+           &wlplan::feature_generator::Features::set_hash_dim,
+           "hash_dim"_a,
+           R"(Hash each (layer, colour key) directly into one of `hash_dim` buckets with a signed hash
+instead of collecting a colour dictionary. The number of features is then fixed and collect() is
+optional. Supported for wl, ccwl, 2-lwl and 2-kwl without pruning. Clears any stored weights.
+
+Parameters
+----------
+    hash_dim : int
+        Number of buckets, or 0 to use a colour dictionary.
+)")
+      .def("get_hash_dim", &wlplan::feature_generator::Features::get_hash_dim)
+      .def("set_frequency_pruning",
+           &wlplan::feature_generator::Features::set_frequency_pruning,
+           "threshold"_a = DEFAULT_FREQUENCY_THRESHOLD,
+           "sketch_width"_a = 0,
+           R"(Set how the `i-f` and `i-mf` pruning options count colours. Colours that occur at most
+`threshold` times the number of graphs over all graphs are pruned. Counts are gathered layer by
+layer during collection, either exactly or in a count-min sketch which overestimates counts and
+hence never prunes more colours than exact counting. Must be called before collect().
+
+Parameters
+----------
+    threshold : float, default=0.01
+        Fraction of the number of graphs in [0, 1].
+
+    sketch_width : int, default=0
+        Number of counters in each of the 4 rows of a count-min sketch, or 0 for exact counts.
+)")
+      .def("get_frequency_threshold",
+           &wlplan::feature_generator::Features::get_frequency_threshold)
+      .def("get_frequency_sketch_width",
+           &wlplan::feature_generator::Features::get_frequency_sketch_width)
+      .def("set_greedy_maxsat",
+           &wlplan::feature_generator::Features::set_greedy_maxsat,
+           "greedy_maxsat"_a,
+           R"(Allow the `a-m`, `i-m` and `i-mf` pruning options to use a native greedy solver if
+pysat cannot be imported, instead of raising an ImportError. The greedy solution satisfies all hard
+clauses but may keep more features than the optimal one. Builds without Python always use it.
+
+Parameters
+----------
+    greedy_maxsat : bool
+        Whether to fall back to the greedy solver.
+)")
+      .def("get_greedy_maxsat", &wlplan::feature_generator::Features::get_greedy_maxsat)
       .def("set_weights", &wlplan::feature_generator::Features::set_weights, "weights"_a)
+      .def("set_sparse_weights",
+           &wlplan::feature_generator::Features::set_sparse_weights,
+           "weights"_a)
       .def("get_weights", &wlplan::feature_generator::Features::get_weights)
+      .def("get_sparse_weights", &wlplan::feature_generator::Features::get_sparse_weights)
       .def("predict",
            py::overload_cast<const wlplan::graph_generator::Graph &>(
                &wlplan::feature_generator::Features::predict),
@@ -694,7 +1256,15 @@ Methods
            py::overload_cast<const std::string &, const std::vector<double> &>(
                &wlplan::feature_generator::Features::save),
            "filename"_a,
-           "weights"_a);
+           "weights"_a)
+      .def("__reduce_ex__",
+           binary_reduce_ex<wlplan::feature_generator::Features>("_wlplan.feature_generator",
+                                                                 "_features_from_buffer"),
+           "protocol"_a);
+
+  feature_generator_m.def("_features_from_buffer",
+                          &__from_buffer__<std::unique_ptr<wlplan::feature_generator::Features>>,
+                          "buffer"_a);
 
   // WLFeatures
   py::class_<wlplan::feature_generator::WLFeatures, wlplan::feature_generator::Features>(
@@ -706,7 +1276,25 @@ Methods
            "graph_representation"_a,
            "iterations"_a,
            "pruning"_a,
-           "multiset_hash"_a);
+           "multiset_hash"_a)
+      .def("set_refinement",
+           &wlplan::feature_generator::WLFeatures::set_refinement,
+           "refinement"_a)
+      .def("get_refinement", &wlplan::feature_generator::WLFeatures::get_refinement)
+      .def("set_signature_hash",
+           &wlplan::feature_generator::WLFeatures::set_signature_hash,
+           "signature_hash"_a,
+           R"(Replace the sorted neighbour key of each node with a 64-bit signature, the sum of mixed
+hashes of its own colour and its (colour, edge label) neighbour pairs. Distinct keys may collide with
+a small probability, which is reported in debug builds. Requires multiset hashing and no pruning,
+and must be called before collect().
+
+Parameters
+----------
+    signature_hash : bool
+        Whether to use signatures as colour keys.
+)")
+      .def("get_signature_hash", &wlplan::feature_generator::WLFeatures::get_signature_hash);
 
   // LWL2Features
   py::class_<wlplan::feature_generator::LWL2Features, wlplan::feature_generator::Features>(
@@ -730,7 +1318,25 @@ Methods
            "graph_representation"_a,
            "iterations"_a,
            "pruning"_a,
-           "multiset_hash"_a);
+           "multiset_hash"_a)
+      .def("set_sampling",
+           &wlplan::feature_generator::KWL2Features::set_sampling,
+           "budget"_a,
+           "seed"_a,
+           R"(Colour only the pairs of a seeded sample of n nodes, with witnesses from the sample, where
+n is the largest value with iterations * n^3 <= budget. Counts are reweighted by the inverse pair
+sampling rate. Must be called before collect().
+
+Parameters
+----------
+    budget : int
+        Maximum number of pair-witness evaluations per graph. 0 disables sampling.
+
+    seed : int
+        Seed for the node sample.
+)")
+      .def("get_sample_budget", &wlplan::feature_generator::KWL2Features::get_sample_budget)
+      .def("get_sample_seed", &wlplan::feature_generator::KWL2Features::get_sample_seed);
 
   // IWLFeatures
   py::class_<wlplan::feature_generator::IWLFeatures, wlplan::feature_generator::Features>(
@@ -778,7 +1384,15 @@ Methods
            "graph_representation"_a,
            "iterations"_a,
            "pruning"_a,
-           "multiset_hash"_a);
+           "multiset_hash"_a)
+      .def("set_selected_pairs",
+           &wlplan::feature_generator::CCWLaFeatures::set_selected_pairs,
+           "pairs"_a)
+      .def("get_selected_pairs", &wlplan::feature_generator::CCWLaFeatures::get_selected_pairs)
+      .def("get_pair_feature_index",
+           &wlplan::feature_generator::CCWLaFeatures::get_pair_feature_index,
+           "i"_a,
+           "j"_a);
 
 //////////////////////////////////////////////////////////////////////////////
 // Version
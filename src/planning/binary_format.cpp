@@ -0,0 +1,242 @@
+#include "../../include/planning/binary_format.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace wlplan {
+  namespace planning {
+    namespace {
+      void write_atoms(utils::BinaryWriter &writer, const std::vector<Atom> &atoms) {
+        writer.write<uint64_t>(atoms.size());
+        for (const Atom &atom : atoms) {
+          writer.write_string(atom.predicate->name);
+          writer.write_strings(atom.objects);
+        }
+      }
+
+      std::vector<Atom>
+      read_atoms(utils::BinaryReader &reader,
+                 const std::unordered_map<std::string, Predicate> &name_to_predicate) {
+        std::vector<Atom> ret;
+        size_t n = reader.read_count();
+        for (size_t i = 0; i < n; i++) {
+          std::string name = reader.read_string();
+          auto it = name_to_predicate.find(name);
+          if (it == name_to_predicate.end()) {
+            throw std::runtime_error("Unknown predicate " + name);
+          }
+          ret.push_back(Atom(it->second, reader.read_strings()));
+        }
+        return ret;
+      }
+
+      // names and arities of predicates, functions or schemata
+      template <typename T>
+      void write_symbols(utils::BinaryWriter &writer, const std::vector<T> &symbols) {
+        writer.write<uint64_t>(symbols.size());
+        for (const T &symbol : symbols) {
+          writer.write_string(symbol.name);
+          writer.write<int32_t>(symbol.arity);
+        }
+      }
+
+      template <typename T>
+      std::vector<T> read_symbols(utils::BinaryReader &reader) {
+        std::vector<T> ret;
+        size_t n = reader.read_count();
+        for (size_t i = 0; i < n; i++) {
+          std::string name = reader.read_string();
+          ret.push_back(T(name, reader.read<int32_t>()));
+        }
+        return ret;
+      }
+    }  // namespace
+
+    void write_domain(utils::BinaryWriter &writer, const Domain &domain) {
+      writer.write_string(domain.name);
+      write_symbols(writer, domain.get_predicates_by_colour());
+      write_symbols(writer, domain.functions);
+      write_symbols(writer, domain.schemata);
+      writer.write_strings(domain.constant_objects);
+    }
+
+    Domain read_domain(utils::BinaryReader &reader) {
+      std::string name = reader.read_string();
+      std::vector<Predicate> predicates = read_symbols<Predicate>(reader);
+      std::vector<Function> functions = read_symbols<Function>(reader);
+      std::vector<Schema> schemata = read_symbols<Schema>(reader);
+      std::vector<Object> constant_objects = reader.read_strings();
+      return Domain(name, predicates, functions, schemata, constant_objects);
+    }
+
+    void write_numeric_condition(utils::BinaryWriter &writer, const NumericCondition &condition) {
+      std::vector<NumericInstruction> program;
+      std::vector<std::string> fluent_names;
+      condition.get_expression()->to_postfix(program, fluent_names);
+      writer.write<int32_t>(condition.get_comparator_type());
+      writer.write<uint64_t>(program.size());
+      for (const NumericInstruction &instruction : program) {
+        writer.write<int32_t>((int)instruction.opcode);
+        writer.write<int32_t>(instruction.fluent_id);
+        writer.write<double>(instruction.constant);
+      }
+      writer.write_strings(fluent_names);
+    }
+
+    NumericCondition read_numeric_condition(utils::BinaryReader &reader) {
+      int comparator_type = reader.read<int32_t>();
+      if (comparator_type < ComparatorType::GreaterThan ||
+          comparator_type > ComparatorType::Equal) {
+        throw std::runtime_error("Unknown comparator type " + std::to_string(comparator_type));
+      }
+      std::vector<NumericInstruction> program(reader.read_count());
+      for (NumericInstruction &instruction : program) {
+        instruction.opcode = (NumericOpcode)reader.read<int32_t>();
+        instruction.fluent_id = reader.read<int32_t>();
+        instruction.constant = reader.read<double>();
+      }
+      std::vector<std::string> fluent_names = reader.read_strings();
+      return NumericCondition((ComparatorType)comparator_type,
+                              NumericExpression::from_postfix(program, fluent_names));
+    }
+
+    void write_problem(utils::BinaryWriter &writer, const Problem &problem) {
+      writer.write_strings(problem.get_problem_objects());
+      write_atoms(writer, problem.get_statics());
+      writer.write<uint64_t>(problem.get_fluents().size());
+      for (const Fluent &fluent : problem.get_fluents()) {
+        writer.write_string(fluent.function->name);
+        writer.write_strings(fluent.objects);
+      }
+      writer.write_vector(problem.get_fluent_values());
+      write_atoms(writer, problem.get_positive_goals());
+      write_atoms(writer, problem.get_negative_goals());
+      writer.write<uint64_t>(problem.get_numeric_goals().size());
+      for (const NumericCondition &condition : problem.get_numeric_goals()) {
+        write_numeric_condition(writer, condition);
+      }
+    }
+
+    Problem read_problem(utils::BinaryReader &reader, const std::shared_ptr<const Domain> &domain) {
+      std::unordered_map<std::string, Predicate> name_to_predicate =
+          domain->get_name_to_predicate();
+      std::unordered_map<std::string, Function> name_to_function = domain->get_name_to_function();
+
+      std::vector<Object> objects = reader.read_strings();
+      std::vector<Atom> statics = read_atoms(reader, name_to_predicate);
+      std::vector<Fluent> fluents;
+      size_t n_fluents = reader.read_count();
+      for (size_t i = 0; i < n_fluents; i++) {
+        std::string name = reader.read_string();
+        auto it = name_to_function.find(name);
+        if (it == name_to_function.end()) {
+          throw std::runtime_error("Unknown function " + name);
+        }
+        fluents.push_back(Fluent(it->second, reader.read_strings()));
+      }
+      std::vector<double> fluent_values = reader.read_vector<double>();
+      std::vector<Atom> positive_goals = read_atoms(reader, name_to_predicate);
+      std::vector<Atom> negative_goals = read_atoms(reader, name_to_predicate);
+      std::vector<NumericCondition> numeric_goals;
+      size_t n_numeric_goals = reader.read_count();
+      for (size_t i = 0; i < n_numeric_goals; i++) {
+        numeric_goals.push_back(read_numeric_condition(reader));
+      }
+      return Problem(domain,
+                     objects,
+                     statics,
+                     fluents,
+                     fluent_values,
+                     positive_goals,
+                     negative_goals,
+                     numeric_goals);
+    }
+
+    void write_symbol_table(utils::BinaryWriter &writer, const SymbolTable &symbol_table) {
+      std::vector<Predicate> predicates;
+      for (int i = 0; i < symbol_table.get_n_predicates(); i++) {
+        predicates.push_back(symbol_table.get_predicate(i));
+      }
+      write_symbols(writer, predicates);
+      writer.write_strings(symbol_table.get_objects());
+    }
+
+    std::shared_ptr<const SymbolTable> read_symbol_table(utils::BinaryReader &reader) {
+      std::vector<Predicate> predicates = read_symbols<Predicate>(reader);
+      std::unordered_map<std::string, int> predicate_to_id;
+      for (size_t i = 0; i < predicates.size(); i++) {
+        if (!predicate_to_id.emplace(predicates[i].name, i).second) {
+          throw std::runtime_error("Duplicate predicate " + predicates[i].name);
+        }
+      }
+      std::vector<Object> objects = reader.read_strings();
+      return std::make_shared<SymbolTable>(predicates, predicate_to_id, objects);
+    }
+
+    std::shared_ptr<const SymbolTable> get_state_symbol_table(const State &state) {
+      if (state.is_packed()) {
+        return state.symbol_table;
+      }
+
+      // symbols of the state in order of occurrence
+      std::vector<Predicate> predicates;
+      std::unordered_map<std::string, int> predicate_to_id;
+      std::vector<Object> objects;
+      std::unordered_set<Object> seen_objects;
+      for (const std::shared_ptr<Atom> &atom : state.atoms) {
+        if (predicate_to_id.emplace(atom->predicate->name, predicates.size()).second) {
+          predicates.push_back(*atom->predicate);
+        }
+        for (const Object &object : atom->objects) {
+          if (seen_objects.insert(object).second) {
+            objects.push_back(object);
+          }
+        }
+      }
+      return std::make_shared<SymbolTable>(predicates, predicate_to_id, objects);
+    }
+
+    void write_state(utils::BinaryWriter &writer,
+                     const State &state,
+                     const SymbolTable &symbol_table) {
+      PackedAtoms atoms;
+      if (state.is_packed() &&
+          (state.symbol_table.get() == &symbol_table || *state.symbol_table == symbol_table)) {
+        atoms = state.packed_atoms;
+      } else {
+        try {
+          atoms = symbol_table.pack(state.get_atoms());
+        } catch (const std::out_of_range &) {
+          throw std::runtime_error("State has symbols that are not in the symbol table");
+        }
+      }
+      writer.write<uint8_t>(state.is_packed());
+      writer.write_vector(atoms.predicates);
+      writer.write_vector(atoms.objects);
+      writer.write_vector(atoms.offsets);
+      writer.write_vector(state.get_values());
+    }
+
+    State read_state(utils::BinaryReader &reader,
+                     const std::shared_ptr<const SymbolTable> &symbol_table) {
+      bool packed = reader.read<uint8_t>();
+      PackedAtoms atoms;
+      atoms.predicates = reader.read_vector<int>();
+      atoms.objects = reader.read_vector<int>();
+      atoms.offsets = reader.read_vector<int>();
+      std::vector<double> values = reader.read_vector<double>();
+      symbol_table->check_packed(atoms);
+
+      if (packed) {
+        return State(symbol_table, atoms, values);
+      }
+      std::vector<Atom> state_atoms;
+      state_atoms.reserve(atoms.size());
+      for (size_t i = 0; i < atoms.size(); i++) {
+        state_atoms.push_back(symbol_table->unpack(atoms, i));
+      }
+      return State(state_atoms, values);
+    }
+  }  // namespace planning
+}  // namespace wlplan
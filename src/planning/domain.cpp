@@ -55,6 +55,14 @@ namespace wlplan {
       return name_to_predicate;
     }
 
+    std::vector<Predicate> Domain::get_predicates_by_colour() const {
+      std::vector<Predicate> ret(predicates.size());
+      for (const Predicate &predicate : predicates) {
+        ret.at(predicate_to_colour.at(predicate.name)) = predicate;
+      }
+      return ret;
+    }
+
     std::unordered_map<std::string, Function> Domain::get_name_to_function() const {
       std::unordered_map<std::string, Function> name_to_function;
       for (const auto &func : functions) {
@@ -1,44 +1,170 @@
 #include "../../include/planning/numeric_condition.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 namespace wlplan {
   namespace planning {
     NumericCondition::NumericCondition(ComparatorType comparator_type,
                                        std::shared_ptr<NumericExpression> expression)
         : comparator_type(comparator_type), expression(expression) {
+      expression->compile(program);
+
+      // each push grows the stack by one and each operation shrinks it by one
+      stack_size = 0;
+      int depth = 0;
+      for (const NumericInstruction &instruction : program) {
+        switch (instruction.opcode) {
+        case NumericOpcode::PushConstant:
+        case NumericOpcode::PushFluent:
+          depth++;
+          break;
+        default:
+          depth--;
+          break;
+        }
+        stack_size = std::max(stack_size, depth);
+      }
+    }
+
+    double NumericCondition::evaluate_expression(const double *values) const {
+      double local_stack[NUMERIC_CONDITION_STACK_SIZE];
+      std::vector<double> heap_stack;
+      double *stack = local_stack;
+      if (stack_size > NUMERIC_CONDITION_STACK_SIZE) {
+        heap_stack.resize(stack_size);
+        stack = heap_stack.data();
+      }
+
+      int top = -1;
+      for (const NumericInstruction &instruction : program) {
+        switch (instruction.opcode) {
+        case NumericOpcode::PushConstant:
+          stack[++top] = instruction.constant;
+          break;
+        case NumericOpcode::PushFluent:
+          stack[++top] = values[instruction.fluent_id];
+          break;
+        case NumericOpcode::Add:
+          top--;
+          stack[top] = stack[top] + stack[top + 1];
+          break;
+        case NumericOpcode::Subtract:
+          top--;
+          stack[top] = stack[top] - stack[top + 1];
+          break;
+        case NumericOpcode::Multiply:
+          top--;
+          stack[top] = stack[top] * stack[top + 1];
+          break;
+        case NumericOpcode::Divide:
+          top--;
+          stack[top] = stack[top] / stack[top + 1];
+          break;
+        }
+      }
+      return top == 0 ? stack[0] : 0;
+    }
+
+    bool NumericCondition::compare(double value) const {
       switch (comparator_type) {
       case ComparatorType::GreaterThan:
-        compare = [](double value) { return value > 0; };
-        error = [](double value) { return std::max(value, 0.0); };
-        break;
+        return value > 0;
       case ComparatorType::GreaterThanOrEqual:
-        compare = [](double value) { return value >= 0; };
-        error = [](double value) { return std::max(value, 0.0); };
-        break;
+        return value >= 0;
+      default:  // case ComparatorType::Equal:
+        return value == 0;
+      }
+    }
+
+    double NumericCondition::error(double value) const {
+      switch (comparator_type) {
       case ComparatorType::Equal:
-        compare = [](double value) { return value == 0; };
-        error = [](double value) { return std::abs(value); };
-        break;
+        return std::abs(value);
+      default:  // case ComparatorType::GreaterThan and ComparatorType::GreaterThanOrEqual:
+        return std::max(value, 0.0);
       }
     }
 
     bool NumericCondition::evaluate_formula(const std::vector<double> &values) const {
-      double value = expression->evaluate(values);
+      double value = evaluate_expression(values.data());
       return compare(value);
     }
 
     double NumericCondition::evaluate_error(const std::vector<double> &values) const {
-      double value = expression->evaluate(values);
+      double value = evaluate_expression(values.data());
       return error(value);
     }
 
     std::pair<bool, double>
     NumericCondition::evaluate_formula_and_error(const std::vector<double> &values) const {
-      double value = expression->evaluate(values);
+      double value = evaluate_expression(values.data());
       return {compare(value), error(value)};
     }
 
+    void NumericCondition::evaluate_batch(const std::vector<double> &values,
+                                          size_t n_states,
+                                          std::vector<bool> &formulas,
+                                          std::vector<double> &errors) const {
+      // the program runs once over rows of n_states entries, so that inner loops vectorise
+      std::vector<double> stack(std::max(stack_size, 1) * n_states);
+      int top = -1;
+      for (const NumericInstruction &instruction : program) {
+        double *row;
+        const double *next;
+        switch (instruction.opcode) {
+        case NumericOpcode::PushConstant:
+          row = stack.data() + ++top * n_states;
+          std::fill(row, row + n_states, instruction.constant);
+          continue;
+        case NumericOpcode::PushFluent:
+          if ((instruction.fluent_id + 1) * n_states > values.size()) {
+            throw std::runtime_error("Missing values of fluent " +
+                                     std::to_string(instruction.fluent_id));
+          }
+          row = stack.data() + ++top * n_states;
+          next = values.data() + instruction.fluent_id * n_states;
+          std::copy(next, next + n_states, row);
+          continue;
+        default:
+          top--;
+          row = stack.data() + top * n_states;
+          next = row + n_states;
+          break;
+        }
+        switch (instruction.opcode) {
+        case NumericOpcode::Add:
+          for (size_t i = 0; i < n_states; i++) {
+            row[i] = row[i] + next[i];
+          }
+          break;
+        case NumericOpcode::Subtract:
+          for (size_t i = 0; i < n_states; i++) {
+            row[i] = row[i] - next[i];
+          }
+          break;
+        case NumericOpcode::Multiply:
+          for (size_t i = 0; i < n_states; i++) {
+            row[i] = row[i] * next[i];
+          }
+          break;
+        default:  // case NumericOpcode::Divide:
+          for (size_t i = 0; i < n_states; i++) {
+            row[i] = row[i] / next[i];
+          }
+          break;
+        }
+      }
+
+      formulas.resize(n_states);
+      errors.resize(n_states);
+      for (size_t i = 0; i < n_states; i++) {
+        formulas[i] = compare(stack[i]);
+        errors[i] = error(stack[i]);
+      }
+    }
+
     std::string NumericCondition::to_string() const {
       std::string comparator;
       switch (comparator_type) {
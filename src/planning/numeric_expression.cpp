@@ -1,5 +1,7 @@
 #include "../../include/planning/numeric_expression.hpp"
 
+#include <stdexcept>
+
 namespace wlplan {
   namespace planning {
     /* FormulaExpression */
@@ -11,18 +13,22 @@ namespace wlplan {
       case OperatorType::Plus:
         op = [](double a, double b) { return a + b; };
         op_symbol = "+";
+        opcode = NumericOpcode::Add;
         break;
       case OperatorType::Minus:
         op = [](double a, double b) { return a - b; };
         op_symbol = "-";
+        opcode = NumericOpcode::Subtract;
         break;
       case OperatorType::Multiply:
         op = [](double a, double b) { return a * b; };
         op_symbol = "*";
+        opcode = NumericOpcode::Multiply;
         break;
       case OperatorType::Divide:
         op = [](double a, double b) { return a / b; };
         op_symbol = "/";
+        opcode = NumericOpcode::Divide;
         break;
       }
     }
@@ -33,6 +39,31 @@ namespace wlplan {
       return op(a, b);
     }
 
+    void FormulaExpression::compile(std::vector<NumericInstruction> &program) const {
+      size_t a_start = program.size();
+      expr_a->compile(program);
+      size_t b_start = program.size();
+      expr_b->compile(program);
+
+      // fold operations on constants, which gives the same result as evaluating them
+      if (b_start - a_start == 1 && program.size() - b_start == 1 &&
+          program[a_start].opcode == NumericOpcode::PushConstant &&
+          program[b_start].opcode == NumericOpcode::PushConstant) {
+        double value = op(program[a_start].constant, program[b_start].constant);
+        program.resize(a_start);
+        program.push_back({NumericOpcode::PushConstant, -1, value});
+        return;
+      }
+      program.push_back({opcode, -1, 0});
+    }
+
+    void FormulaExpression::to_postfix(std::vector<NumericInstruction> &program,
+                                       std::vector<std::string> &fluent_names) const {
+      expr_a->to_postfix(program, fluent_names);
+      expr_b->to_postfix(program, fluent_names);
+      program.push_back({opcode, -1, 0});
+    }
+
     std::vector<int> FormulaExpression::get_fluent_ids() const {
       std::vector<int> ids_a = expr_a->get_fluent_ids();
       std::vector<int> ids_b = expr_b->get_fluent_ids();
@@ -51,6 +82,14 @@ namespace wlplan {
       (void)values;  // to avoid unused variable warnings
       return value;
     }
+    void ConstantExpression::compile(std::vector<NumericInstruction> &program) const {
+      program.push_back({NumericOpcode::PushConstant, -1, value});
+    }
+    void ConstantExpression::to_postfix(std::vector<NumericInstruction> &program,
+                                        std::vector<std::string> &fluent_names) const {
+      (void)fluent_names;
+      compile(program);
+    }
     std::vector<int> ConstantExpression::get_fluent_ids() const { return {}; }
     std::string ConstantExpression::to_string() const { return std::to_string(value); }
 
@@ -61,8 +100,64 @@ namespace wlplan {
     double FluentExpression::evaluate(const std::vector<double> &values) const {
       return values[id];
     }
+    void FluentExpression::compile(std::vector<NumericInstruction> &program) const {
+      program.push_back({NumericOpcode::PushFluent, id, 0});
+    }
+    void FluentExpression::to_postfix(std::vector<NumericInstruction> &program,
+                                      std::vector<std::string> &fluent_names) const {
+      compile(program);
+      fluent_names.push_back(fluent_name);
+    }
     std::vector<int> FluentExpression::get_fluent_ids() const { return {id}; }
     std::string FluentExpression::to_string() const { return fluent_name; }
 
+    /* NumericExpression */
+
+    std::shared_ptr<NumericExpression>
+    NumericExpression::from_postfix(const std::vector<NumericInstruction> &program,
+                                    const std::vector<std::string> &fluent_names) {
+      std::vector<std::shared_ptr<NumericExpression>> stack;
+      size_t n_fluents = 0;
+      for (const NumericInstruction &instruction : program) {
+        OperatorType op_type;
+        switch (instruction.opcode) {
+        case NumericOpcode::PushConstant:
+          stack.push_back(std::make_shared<ConstantExpression>(instruction.constant));
+          continue;
+        case NumericOpcode::PushFluent:
+          if (n_fluents == fluent_names.size()) {
+            throw std::runtime_error("Missing fluent names of numeric expression");
+          }
+          stack.push_back(std::make_shared<FluentExpression>(instruction.fluent_id,
+                                                             fluent_names[n_fluents++]));
+          continue;
+        case NumericOpcode::Add:
+          op_type = OperatorType::Plus;
+          break;
+        case NumericOpcode::Subtract:
+          op_type = OperatorType::Minus;
+          break;
+        case NumericOpcode::Multiply:
+          op_type = OperatorType::Multiply;
+          break;
+        case NumericOpcode::Divide:
+          op_type = OperatorType::Divide;
+          break;
+        default:
+          throw std::runtime_error("Unknown numeric opcode");
+        }
+        if (stack.size() < 2) {
+          throw std::runtime_error("Numeric expression program pops an empty stack");
+        }
+        std::shared_ptr<NumericExpression> b = stack.back();
+        stack.pop_back();
+        stack.back() = std::make_shared<FormulaExpression>(op_type, stack.back(), b);
+      }
+      if (stack.size() != 1 || n_fluents != fluent_names.size()) {
+        throw std::runtime_error("Numeric expression program does not give one expression");
+      }
+      return stack[0];
+    }
+
   }  // namespace planning
 }  // namespace wlplan
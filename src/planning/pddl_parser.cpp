@@ -0,0 +1,505 @@
+#include "../../include/planning/pddl_parser.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace wlplan {
+  namespace planning {
+    namespace {
+      // A symbol if list is empty and is_list is false, otherwise a parenthesised list
+      struct SExpr {
+        std::string symbol;
+        std::vector<SExpr> list;
+        bool is_list = false;
+
+        std::string to_string() const {
+          if (!is_list) {
+            return symbol;
+          }
+          std::string ret = "(";
+          for (size_t i = 0; i < list.size(); i++) {
+            if (i > 0) {
+              ret += " ";
+            }
+            ret += list[i].to_string();
+          }
+          return ret + ")";
+        }
+      };
+
+      std::string lower(std::string str) {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) {
+          return std::tolower(c);
+        });
+        return str;
+      }
+
+      bool is_keyword(const SExpr &expr, const std::string &keyword) {
+        return !expr.is_list && lower(expr.symbol) == keyword;
+      }
+
+      // head symbol of a list in lower case, or the empty string
+      std::string head(const SExpr &expr) {
+        if (!expr.is_list || expr.list.empty() || expr.list[0].is_list) {
+          return "";
+        }
+        return lower(expr.list[0].symbol);
+      }
+
+      class SExprReader {
+        const std::string &text;
+        const std::string &path;
+        size_t pos = 0;
+
+        void skip_whitespace_and_comments() {
+          while (pos < text.size()) {
+            if (std::isspace((unsigned char)text[pos])) {
+              pos++;
+            } else if (text[pos] == ';') {
+              while (pos < text.size() && text[pos] != '\n') {
+                pos++;
+              }
+            } else {
+              break;
+            }
+          }
+        }
+
+        std::runtime_error error(const std::string &message) const {
+          return std::runtime_error("Failed to parse " + path + ": " + message);
+        }
+
+       public:
+        SExprReader(const std::string &text, const std::string &path) : text(text), path(path) {}
+
+        SExpr read() {
+          skip_whitespace_and_comments();
+          if (pos >= text.size()) {
+            throw error("unexpected end of file");
+          }
+          SExpr ret;
+          if (text[pos] == ')') {
+            throw error("unexpected ')'");
+          } else if (text[pos] == '(') {
+            pos++;
+            ret.is_list = true;
+            skip_whitespace_and_comments();
+            while (pos < text.size() && text[pos] != ')') {
+              ret.list.push_back(read());
+              skip_whitespace_and_comments();
+            }
+            if (pos >= text.size()) {
+              throw error("missing ')'");
+            }
+            pos++;
+          } else {
+            size_t start = pos;
+            while (pos < text.size() && !std::isspace((unsigned char)text[pos]) &&
+                   text[pos] != '(' && text[pos] != ')' && text[pos] != ';') {
+              pos++;
+            }
+            ret.symbol = text.substr(start, pos - start);
+          }
+          return ret;
+        }
+
+        bool done() {
+          skip_whitespace_and_comments();
+          return pos >= text.size();
+        }
+      };
+
+      // reads a file containing a single (define ...) expression
+      SExpr read_define(const std::string &path) {
+        std::ifstream file(path);
+        if (!file.good()) {
+          throw std::runtime_error("Cannot open PDDL file " + path);
+        }
+        std::stringstream buffer;
+        buffer << file.rdbuf();
+        std::string text = buffer.str();
+
+        SExprReader reader(text, path);
+        SExpr ret = reader.read();
+        if (!reader.done()) {
+          throw std::runtime_error("Failed to parse " + path + ": trailing input after define");
+        }
+        if (head(ret) != "define" || ret.list.size() < 2 || ret.list[1].list.size() != 2) {
+          throw std::runtime_error("Failed to parse " + path +
+                                   ": expected (define (<kind> <name>) ...)");
+        }
+        return ret;
+      }
+
+      // names of a typed list such as `?x ?y - block ?z - (either a b)`, ignoring types
+      std::vector<std::string> typed_list_names(const std::vector<SExpr> &list, size_t start) {
+        std::vector<std::string> ret;
+        for (size_t i = start; i < list.size(); i++) {
+          if (is_keyword(list[i], "-")) {
+            i++;  // skip the type
+          } else if (!list[i].is_list) {
+            ret.push_back(list[i].symbol);
+          }
+        }
+        return ret;
+      }
+
+      // heads of effects and conditions that are not atoms
+      const std::set<std::string> NON_ATOM_HEADS = {"and", "or", "not", "imply", "exists",
+                                                     "forall", "when", "increase", "decrease",
+                                                     "assign", "scale-up", "scale-down", "=",
+                                                     "<", "<=", ">", ">="};
+
+      void collect_effect_predicates(const SExpr &effect,
+                                     std::map<std::string, Predicate> &predicates) {
+        std::vector<const SExpr *> effects;
+        if (head(effect) == "and") {
+          for (size_t i = 1; i < effect.list.size(); i++) {
+            effects.push_back(&effect.list[i]);
+          }
+        } else {
+          effects.push_back(&effect);
+        }
+        for (const SExpr *e : effects) {
+          if (head(*e) == "not" && e->list.size() == 2) {
+            e = &e->list[1];
+          }
+          if (!e->is_list || e->list.empty() || NON_ATOM_HEADS.count(head(*e))) {
+            continue;
+          }
+          Predicate predicate(e->list[0].symbol, (int)e->list.size() - 1);
+          auto it = predicates.find(predicate.name);
+          if (it == predicates.end()) {
+            predicates.emplace(predicate.name, predicate);
+          } else if (!(it->second == predicate)) {
+            throw std::runtime_error("Predicate " + predicate.name +
+                                     " occurs with different arities in action effects");
+          }
+        }
+      }
+
+      Domain to_domain(const SExpr &define,
+                       const std::string &domain_name,
+                       bool keep_statics) {
+        if (head(define.list[1]) != "domain") {
+          throw std::runtime_error("Expected (define (domain <name>) ...)");
+        }
+        std::string name = domain_name.empty() ? define.list[1].list[1].symbol : domain_name;
+
+        std::map<std::string, Predicate> declared_predicates;
+        std::map<std::string, Predicate> effect_predicates;
+        std::vector<Function> functions;
+        std::vector<Schema> schemata;
+        std::vector<Object> constant_objects;
+
+        for (size_t i = 2; i < define.list.size(); i++) {
+          const SExpr &section = define.list[i];
+          std::string kind = head(section);
+          if (kind == ":constants") {
+            for (const std::string &object : typed_list_names(section.list, 1)) {
+              constant_objects.push_back(object);
+            }
+          } else if (kind == ":predicates" || kind == ":functions") {
+            for (size_t j = 1; j < section.list.size(); j++) {
+              const SExpr &term = section.list[j];
+              if (is_keyword(term, "-")) {
+                j++;  // skip function types
+                continue;
+              }
+              if (!term.is_list || term.list.empty() || term.list[0].is_list) {
+                throw std::runtime_error("Unexpected " + term.to_string() + " in " + kind);
+              }
+              const std::string &term_name = term.list[0].symbol;
+              int arity = typed_list_names(term.list, 1).size();
+              if (kind == ":predicates") {
+                declared_predicates.emplace(term_name, Predicate(term_name, arity));
+              } else {
+                functions.push_back(Function(term_name, arity));
+              }
+            }
+          } else if (kind == ":action" || kind == ":durative-action") {
+            if (section.list.size() < 2 || section.list[1].is_list) {
+              throw std::runtime_error("Expected a name for " + section.to_string());
+            }
+            int arity = 0;
+            for (size_t j = 2; j + 1 < section.list.size(); j += 2) {
+              std::string field = lower(section.list[j].symbol);
+              if (field == ":parameters") {
+                arity = typed_list_names(section.list[j + 1].list, 0).size();
+              } else if (field == ":effect") {
+                collect_effect_predicates(section.list[j + 1], effect_predicates);
+              }
+            }
+            schemata.push_back(Schema(section.list[1].symbol, arity));
+          }
+        }
+
+        std::vector<Predicate> predicates;
+        for (const auto &[_, predicate] : keep_statics ? declared_predicates : effect_predicates) {
+          predicates.push_back(predicate);
+        }
+        std::sort(constant_objects.begin(), constant_objects.end());
+        return Domain(name, predicates, functions, schemata, constant_objects);
+      }
+
+      std::shared_ptr<NumericExpression>
+      to_expression(const SExpr &expr, const std::unordered_map<std::string, int> &fluent_to_id) {
+        if (!expr.is_list) {
+          size_t n_read = 0;
+          double value;
+          try {
+            value = std::stod(expr.symbol, &n_read);
+          } catch (const std::exception &) {
+            n_read = 0;
+          }
+          if (n_read == 0 || n_read != expr.symbol.size()) {
+            throw std::runtime_error("Expected a number but got " + expr.symbol);
+          }
+          return std::make_shared<ConstantExpression>(value);
+        }
+
+        static const std::unordered_map<std::string, OperatorType> operators = {
+            {"+", OperatorType::Plus},
+            {"-", OperatorType::Minus},
+            {"*", OperatorType::Multiply},
+            {"/", OperatorType::Divide},
+        };
+        std::string op = head(expr);
+        if (operators.count(op)) {
+          if (expr.list.size() < 2) {
+            throw std::runtime_error("Missing operands in " + expr.to_string());
+          }
+          std::shared_ptr<NumericExpression> ret = to_expression(expr.list[1], fluent_to_id);
+          if (expr.list.size() == 2) {
+            if (op != "-") {
+              return ret;
+            }
+            // unary minus
+            return std::make_shared<FormulaExpression>(
+                OperatorType::Minus, std::make_shared<ConstantExpression>(0), ret);
+          }
+          for (size_t i = 2; i < expr.list.size(); i++) {
+            ret = std::make_shared<FormulaExpression>(
+                operators.at(op), ret, to_expression(expr.list[i], fluent_to_id));
+          }
+          return ret;
+        }
+
+        if (expr.list.empty() || expr.list[0].is_list) {
+          throw std::runtime_error("Unexpected numeric expression " + expr.to_string());
+        }
+        std::string fluent_name = expr.list[0].symbol + "(";
+        for (size_t i = 1; i < expr.list.size(); i++) {
+          fluent_name += (i > 1 ? ", " : "") + expr.list[i].symbol;
+        }
+        fluent_name += ")";
+        auto it = fluent_to_id.find(fluent_name);
+        if (it == fluent_to_id.end()) {
+          throw std::runtime_error("Fluent " + fluent_name + " has no initial value");
+        }
+        return std::make_shared<FluentExpression>(it->second, fluent_name);
+      }
+
+      Atom to_atom(const SExpr &expr,
+                   const std::unordered_map<std::string, Predicate> &name_to_predicate) {
+        if (!expr.is_list || expr.list.empty() || expr.list[0].is_list) {
+          throw std::runtime_error("Expected an atom but got " + expr.to_string());
+        }
+        auto it = name_to_predicate.find(expr.list[0].symbol);
+        if (it == name_to_predicate.end()) {
+          throw std::runtime_error("Unknown predicate in goal " + expr.to_string());
+        }
+        std::vector<Object> objects;
+        for (size_t i = 1; i < expr.list.size(); i++) {
+          objects.push_back(expr.list[i].symbol);
+        }
+        return Atom(it->second, objects);
+      }
+
+      Problem to_problem(const std::shared_ptr<const Domain> &domain, const SExpr &define) {
+        if (head(define.list[1]) != "problem") {
+          throw std::runtime_error("Expected (define (problem <name>) ...)");
+        }
+        std::unordered_map<std::string, Predicate> name_to_predicate =
+            domain->get_name_to_predicate();
+        std::unordered_map<std::string, Function> name_to_function = domain->get_name_to_function();
+
+        std::vector<Object> objects;
+        std::vector<std::pair<std::string, std::pair<Fluent, double>>> init_fluents;
+        const SExpr *goal = nullptr;
+
+        for (size_t i = 2; i < define.list.size(); i++) {
+          const SExpr &section = define.list[i];
+          std::string kind = head(section);
+          if (kind == ":objects") {
+            objects = typed_list_names(section.list, 1);
+          } else if (kind == ":init") {
+            for (size_t j = 1; j < section.list.size(); j++) {
+              const SExpr &formula = section.list[j];
+              // only initial fluent values are used, as in the pddl based parser
+              if (head(formula) != "=" || formula.list.size() != 3) {
+                continue;
+              }
+              const SExpr &variable = formula.list[1];
+              if (!variable.is_list || variable.list.empty() || variable.list[0].is_list) {
+                throw std::runtime_error("Unexpected initial value " + formula.to_string());
+              }
+              auto function = name_to_function.find(variable.list[0].symbol);
+              if (function == name_to_function.end()) {
+                throw std::runtime_error("Unknown function in " + formula.to_string());
+              }
+              std::vector<Object> fluent_objects;
+              for (size_t k = 1; k < variable.list.size(); k++) {
+                fluent_objects.push_back(variable.list[k].symbol);
+              }
+              double value = to_expression(formula.list[2], {})->evaluate({});
+              init_fluents.push_back({variable.to_string(),
+                                      {Fluent(function->second, fluent_objects), value}});
+            }
+          } else if (kind == ":goal") {
+            if (section.list.size() != 2) {
+              throw std::runtime_error("Expected a single goal formula in " + section.to_string());
+            }
+            goal = &section.list[1];
+          }
+        }
+        std::sort(objects.begin(), objects.end());
+
+        // fluent ids follow the pddl based parser, which sorts initial value formulas by their
+        // text; the balanced fluent terms come first in it and decide the order
+        std::stable_sort(init_fluents.begin(),
+                         init_fluents.end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+        std::vector<Fluent> fluents;
+        std::vector<double> fluent_values;
+        std::unordered_map<std::string, int> fluent_to_id;
+        for (const auto &[_, fluent_value] : init_fluents) {
+          fluent_to_id[fluent_value.first.to_string()] = fluents.size();
+          fluents.push_back(fluent_value.first);
+          fluent_values.push_back(fluent_value.second);
+        }
+
+        std::vector<Atom> positive_goals;
+        std::vector<Atom> negative_goals;
+        std::vector<NumericCondition> numeric_goals;
+        std::vector<const SExpr *> goals;
+        if (goal != nullptr && head(*goal) == "and") {
+          for (size_t i = 1; i < goal->list.size(); i++) {
+            goals.push_back(&goal->list[i]);
+          }
+        } else if (goal != nullptr) {
+          goals.push_back(goal);
+        }
+
+        for (const SExpr *g : goals) {
+          std::string kind = head(*g);
+          if (kind == "not" && g->list.size() == 2) {
+            negative_goals.push_back(to_atom(g->list[1], name_to_predicate));
+          } else if (kind == "=" || kind == "<" || kind == "<=" || kind == ">" || kind == ">=") {
+            if (g->list.size() != 3) {
+              throw std::runtime_error("Expected a binary comparison but got " + g->to_string());
+            }
+            // convert to a normal form of [expression \unrhd 0]
+            std::shared_ptr<NumericExpression> lhs = to_expression(g->list[1], fluent_to_id);
+            std::shared_ptr<NumericExpression> rhs = to_expression(g->list[2], fluent_to_id);
+            ComparatorType comparator_type;
+            if (kind == "=") {
+              comparator_type = ComparatorType::Equal;
+            } else if (kind == "<" || kind == ">") {
+              comparator_type = ComparatorType::GreaterThan;
+            } else {
+              comparator_type = ComparatorType::GreaterThanOrEqual;
+            }
+            if (kind == "<" || kind == "<=") {
+              std::swap(lhs, rhs);
+            }
+            numeric_goals.push_back(NumericCondition(
+                comparator_type,
+                std::make_shared<FormulaExpression>(OperatorType::Minus, lhs, rhs)));
+          } else if (kind.empty() || NON_ATOM_HEADS.count(kind)) {
+            throw std::runtime_error("Unsupported goal " + g->to_string());
+          } else {
+            positive_goals.push_back(to_atom(*g, name_to_predicate));
+          }
+        }
+
+        return Problem(domain,
+                       objects,
+                       std::vector<Atom>(),
+                       fluents,
+                       fluent_values,
+                       positive_goals,
+                       negative_goals,
+                       numeric_goals);
+      }
+    }  // namespace
+
+    Domain parse_domain(const std::string &domain_path,
+                        const std::string &domain_name,
+                        bool keep_statics) {
+      return to_domain(read_define(domain_path), domain_name, keep_statics);
+    }
+
+    Problem parse_problem(const std::string &domain_path,
+                          const std::string &problem_path,
+                          bool keep_statics) {
+      auto domain = std::make_shared<const Domain>(parse_domain(domain_path, "", keep_statics));
+      return to_problem(domain, read_define(problem_path));
+    }
+
+    std::vector<Problem> parse_problems(const std::string &domain_path,
+                                        const std::vector<std::string> &problem_paths,
+                                        bool keep_statics,
+                                        int n_threads) {
+      // problems share one domain
+      auto domain = std::make_shared<const Domain>(parse_domain(domain_path, "", keep_statics));
+      size_t n_problems = problem_paths.size();
+      if (n_threads <= 0) {
+        n_threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      n_threads = std::min<size_t>(n_threads, n_problems);
+
+      std::vector<std::unique_ptr<Problem>> problems(n_problems);
+      std::vector<std::exception_ptr> errors(n_problems);
+      std::atomic<size_t> next(0);
+      auto worker = [&]() {
+        for (size_t i = next++; i < n_problems; i = next++) {
+          try {
+            SExpr define = read_define(problem_paths[i]);
+            problems[i] = std::make_unique<Problem>(to_problem(domain, define));
+          } catch (...) {
+            errors[i] = std::current_exception();
+          }
+        }
+      };
+      std::vector<std::thread> threads;
+      for (int t = 1; t < n_threads; t++) {
+        threads.emplace_back(worker);
+      }
+      worker();
+      for (std::thread &thread : threads) {
+        thread.join();
+      }
+
+      std::vector<Problem> ret;
+      ret.reserve(n_problems);
+      for (size_t i = 0; i < n_problems; i++) {
+        if (errors[i]) {
+          std::rethrow_exception(errors[i]);
+        }
+        ret.push_back(std::move(*problems[i]));
+      }
+      return ret;
+    }
+  }  // namespace planning
+}  // namespace wlplan
@@ -9,7 +9,7 @@
 
 namespace wlplan {
   namespace planning {
-    Problem::Problem(const Domain &domain,
+    Problem::Problem(const std::shared_ptr<const Domain> &domain,
                      const std::vector<Object> &objects,
                      const std::vector<Atom> &statics,
                      const std::vector<Fluent> &fluents,
@@ -17,7 +17,7 @@ namespace wlplan {
                      const std::vector<Atom> &positive_goals,
                      const std::vector<Atom> &negative_goals,
                      const std::vector<NumericCondition> &numeric_goals)
-        : domain(std::make_shared<Domain>(domain)),
+        : domain(domain),
           statics(statics),
           fluents(fluents),
           fluent_values(fluent_values),
@@ -25,25 +25,26 @@ namespace wlplan {
           negative_goals(negative_goals),
           numeric_goals(numeric_goals) {
 
-      // handle objects
-      int cnt = 0;
-      for (const auto &object : domain.constant_objects) {
-        object_to_id[object] = cnt;
+      // handle objects, whose ids list constant objects first
+      std::vector<Object> all_objects;
+      for (const auto &object : domain->constant_objects) {
         constant_objects_set.insert(object);
         constant_objects.push_back(object);
-        cnt++;
+        all_objects.push_back(object);
       }
 
       for (const auto &object : objects) {
         if (constant_objects_set.count(object)) {
           continue;
         }
-        object_to_id[object] = cnt;
         constant_objects_set.insert(object);
         problem_objects.push_back(object);
-        cnt++;
+        all_objects.push_back(object);
       }
 
+      symbol_table = std::make_shared<SymbolTable>(
+          domain->predicates, domain->predicate_to_colour, all_objects);
+
       // handle fluents
       if (fluents.size() != fluent_values.size()) {
         std::cout << "Error: Number of fluent variables and fluent values do not match."
@@ -57,6 +58,23 @@ namespace wlplan {
       }
     }
 
+    Problem::Problem(const Domain &domain,
+                     const std::vector<Object> &objects,
+                     const std::vector<Atom> &statics,
+                     const std::vector<Fluent> &fluents,
+                     const std::vector<double> &fluent_values,
+                     const std::vector<Atom> &positive_goals,
+                     const std::vector<Atom> &negative_goals,
+                     const std::vector<NumericCondition> &numeric_goals)
+        : Problem(std::make_shared<const Domain>(domain),
+                  objects,
+                  statics,
+                  fluents,
+                  fluent_values,
+                  positive_goals,
+                  negative_goals,
+                  numeric_goals) {}
+
     Problem::Problem(const Domain &domain,
                      const std::vector<Object> &objects,
                      const std::vector<Fluent> &fluents,
@@ -1,18 +1,52 @@
 #include "../../include/planning/state.hpp"
 
+#include "../../include/utils/hashing.hpp"
+
 #include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace {
+  bool equal_packed_atoms(const wlplan::planning::PackedAtoms &atoms,
+                          size_t i,
+                          const wlplan::planning::PackedAtoms &other,
+                          size_t j) {
+    return atoms.predicates[i] == other.predicates[j] &&
+           std::equal(atoms.get_objects(i),
+                      atoms.get_objects(i) + atoms.get_arity(i),
+                      other.get_objects(j),
+                      other.get_objects(j) + other.get_arity(j));
+  }
+
+  // index of atom j of other in atoms, or -1 if it is not contained
+  int find_packed_atom(const wlplan::planning::PackedAtoms &atoms,
+                       const wlplan::planning::PackedAtoms &other,
+                       size_t j) {
+    for (size_t i = 0; i < atoms.size(); i++) {
+      if (equal_packed_atoms(atoms, i, other, j)) {
+        return i;
+      }
+    }
+    return -1;
+  }
+}  // namespace
 
 namespace wlplan {
   namespace planning {
     State::State(const std::vector<std::shared_ptr<Atom>> &atoms, const std::vector<double> &values)
-        : atoms(atoms), values(values) {}
+        : atoms(atoms), values(values) {
+      init_atoms_hash();
+    }
 
-    State::State(const std::vector<std::shared_ptr<Atom>> &atoms) : atoms(atoms) {}
+    State::State(const std::vector<std::shared_ptr<Atom>> &atoms) : atoms(atoms) {
+      init_atoms_hash();
+    }
 
     State::State(const std::vector<Atom> &atoms) {
       for (const Atom &atom : atoms) {
         this->atoms.push_back(std::make_shared<Atom>(atom));
       }
+      init_atoms_hash();
     }
 
     State::State(const std::vector<Atom> &atoms, const std::vector<double> &values) {
@@ -20,27 +54,157 @@ namespace wlplan {
         this->atoms.push_back(std::make_shared<Atom>(atom));
       }
       this->values = values;
+      init_atoms_hash();
+    }
+
+    State::State(const std::shared_ptr<const SymbolTable> &symbol_table,
+                 const PackedAtoms &atoms,
+                 const std::vector<double> &values)
+        : packed_atoms(atoms), symbol_table(symbol_table), values(values) {
+      init_atoms_hash();
+    }
+
+    State::State(const std::shared_ptr<const SymbolTable> &symbol_table, const PackedAtoms &atoms)
+        : packed_atoms(atoms), symbol_table(symbol_table) {
+      init_atoms_hash();
+    }
+
+    void State::init_atoms_hash() {
+      atoms_hash = 0;
+      if (is_packed()) {
+        for (size_t i = 0; i < packed_atoms.size(); i++) {
+          atoms_hash += symbol_table->atom_key(packed_atoms, i);
+        }
+      } else {
+        for (const std::shared_ptr<Atom> &atom : atoms) {
+          atoms_hash += SymbolTable::atom_key(*atom);
+        }
+      }
     }
 
     std::vector<Atom> State::get_atoms() const {
       std::vector<Atom> ret;
+      if (is_packed()) {
+        ret.reserve(packed_atoms.size());
+        for (size_t i = 0; i < packed_atoms.size(); i++) {
+          ret.push_back(symbol_table->unpack(packed_atoms, i));
+        }
+        return ret;
+      }
       for (const std::shared_ptr<Atom> &atom : atoms) {
         ret.push_back(*atom);
       }
       return ret;
     }
 
-    std::vector<double> State::get_values() const { return values; }
+    std::vector<std::shared_ptr<Atom>> State::get_atom_pointers() const {
+      if (!is_packed()) {
+        return atoms;
+      }
+      std::vector<std::shared_ptr<Atom>> ret;
+      ret.reserve(packed_atoms.size());
+      for (size_t i = 0; i < packed_atoms.size(); i++) {
+        ret.push_back(std::make_shared<Atom>(symbol_table->unpack(packed_atoms, i)));
+      }
+      return ret;
+    }
+
+    State State::successor(const std::vector<Atom> &add_atoms,
+                           const std::vector<Atom> &delete_atoms,
+                           const std::vector<double> &values) const {
+      if (is_packed()) {
+        return successor(symbol_table->pack(add_atoms), symbol_table->pack(delete_atoms), values);
+      }
+
+      State ret = *this;
+      ret.values = values;
+      auto find = [&ret](const Atom &atom) {
+        return std::find_if(ret.atoms.begin(), ret.atoms.end(), [&atom](const auto &other) {
+          return other->predicate->name == atom.predicate->name && other->objects == atom.objects;
+        });
+      };
+      for (const Atom &atom : delete_atoms) {
+        auto it = find(atom);
+        if (it != ret.atoms.end()) {
+          ret.atoms.erase(it);
+          ret.atoms_hash -= SymbolTable::atom_key(atom);
+        }
+      }
+      for (const Atom &atom : add_atoms) {
+        if (find(atom) == ret.atoms.end()) {
+          ret.atoms.push_back(std::make_shared<Atom>(atom));
+          ret.atoms_hash += SymbolTable::atom_key(atom);
+        }
+      }
+      return ret;
+    }
+
+    State State::successor(const std::vector<Atom> &add_atoms,
+                           const std::vector<Atom> &delete_atoms) const {
+      return successor(add_atoms, delete_atoms, values);
+    }
+
+    State State::successor(const PackedAtoms &add_atoms,
+                           const PackedAtoms &delete_atoms,
+                           const std::vector<double> &values) const {
+      if (!is_packed()) {
+        throw std::runtime_error("Packed effects can only be applied to packed states");
+      }
+
+      State ret = *this;
+      ret.values = values;
+      ret.packed_atoms = PackedAtoms();
+      for (size_t i = 0; i < packed_atoms.size(); i++) {
+        if (find_packed_atom(delete_atoms, packed_atoms, i) == -1) {
+          const int *objects = packed_atoms.get_objects(i);
+          ret.packed_atoms.push_back(
+              packed_atoms.predicates[i],
+              std::vector<int>(objects, objects + packed_atoms.get_arity(i)));
+        } else {
+          ret.atoms_hash -= symbol_table->atom_key(packed_atoms, i);
+        }
+      }
+      for (size_t i = 0; i < add_atoms.size(); i++) {
+        if (find_packed_atom(ret.packed_atoms, add_atoms, i) == -1) {
+          const int *objects = add_atoms.get_objects(i);
+          ret.packed_atoms.push_back(add_atoms.predicates[i],
+                                     std::vector<int>(objects, objects + add_atoms.get_arity(i)));
+          ret.atoms_hash += symbol_table->atom_key(add_atoms, i);
+        }
+      }
+      return ret;
+    }
+
+    std::vector<std::string> State::get_sorted_atom_strings() const {
+      std::vector<std::string> ret;
+      ret.reserve(get_n_atoms());
+      for (size_t i = 0; i < packed_atoms.size() && is_packed(); i++) {
+        ret.push_back(symbol_table->unpack(packed_atoms, i).to_string());
+      }
+      for (size_t i = 0; i < atoms.size(); i++) {
+        ret.push_back(atoms[i]->to_string());
+      }
+      std::sort(ret.begin(), ret.end());
+      return ret;
+    }
+
+    std::vector<std::vector<int>> State::get_sorted_packed_atoms() const {
+      std::vector<std::vector<int>> ret;
+      ret.reserve(packed_atoms.size());
+      for (size_t i = 0; i < packed_atoms.size(); i++) {
+        const int *objects = packed_atoms.get_objects(i);
+        ret.push_back({packed_atoms.predicates[i]});
+        ret.back().insert(ret.back().end(), objects, objects + packed_atoms.get_arity(i));
+      }
+      std::sort(ret.begin(), ret.end());
+      return ret;
+    }
 
     std::string State::to_string() const {
       std::string ret = "State(atoms=[";
 
       // sort atoms because order does not matter
-      std::vector<std::string> atom_strings;
-      for (size_t i = 0; i < atoms.size(); i++) {
-        atom_strings.push_back(atoms[i]->to_string());
-      }
-      std::sort(atom_strings.begin(), atom_strings.end());
+      std::vector<std::string> atom_strings = get_sorted_atom_strings();
       for (size_t i = 0; i < atom_strings.size(); i++) {
         ret += atom_strings[i];
         if (i < atom_strings.size() - 1) {
@@ -61,9 +225,23 @@ namespace wlplan {
     }
 
     bool State::operator==(const State &other) const {
-      return atoms == other.atoms && values == other.values;
+      if (atoms_hash != other.atoms_hash || get_n_atoms() != other.get_n_atoms() ||
+          values != other.values) {
+        return false;
+      }
+      if (is_packed() && other.is_packed() &&
+          (symbol_table == other.symbol_table || *symbol_table == *other.symbol_table)) {
+        return get_sorted_packed_atoms() == other.get_sorted_packed_atoms();
+      }
+      return get_sorted_atom_strings() == other.get_sorted_atom_strings();
     }
 
-    size_t State::hash() const { return std::hash<std::string>()(to_string()); }
+    size_t State::hash() const {
+      uint64_t ret = atoms_hash;
+      for (const double value : values) {
+        ret = utils::mix64(ret ^ std::hash<double>()(value));
+      }
+      return ret;
+    }
   }  // namespace planning
 }  // namespace wlplan
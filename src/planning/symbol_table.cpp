@@ -0,0 +1,117 @@
+#include "../../include/planning/symbol_table.hpp"
+
+#include "../../include/utils/hashing.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace wlplan {
+  namespace planning {
+    PackedAtoms::PackedAtoms(const int *predicates,
+                             const int *objects,
+                             const int *offsets,
+                             size_t n_atoms)
+        : predicates(predicates, predicates + n_atoms),
+          objects(objects + offsets[0], objects + offsets[n_atoms]),
+          offsets(offsets, offsets + n_atoms + 1) {
+      for (int &offset : this->offsets) {
+        offset -= offsets[0];
+      }
+    }
+
+    void PackedAtoms::push_back(int predicate, const std::vector<int> &atom_objects) {
+      predicates.push_back(predicate);
+      objects.insert(objects.end(), atom_objects.begin(), atom_objects.end());
+      offsets.push_back(objects.size());
+    }
+
+    SymbolTable::SymbolTable(const std::vector<Predicate> &predicates,
+                             const std::unordered_map<std::string, int> &predicate_to_id,
+                             const std::vector<Object> &objects)
+        : predicates(predicates.size()), objects(objects), predicate_to_id(predicate_to_id) {
+      for (const Predicate &predicate : predicates) {
+        this->predicates.at(predicate_to_id.at(predicate.name)) = predicate;
+      }
+      for (size_t i = 0; i < objects.size(); i++) {
+        object_to_id[objects[i]] = i;
+      }
+      for (const Predicate &predicate : this->predicates) {
+        predicate_hashes.push_back(name_hash(predicate.name));
+      }
+      for (const Object &object : objects) {
+        object_hashes.push_back(name_hash(object));
+      }
+    }
+
+    PackedAtoms SymbolTable::pack(const std::vector<Atom> &atoms) const {
+      PackedAtoms ret;
+      ret.predicates.reserve(atoms.size());
+      ret.offsets.reserve(atoms.size() + 1);
+      for (const Atom &atom : atoms) {
+        ret.predicates.push_back(get_predicate_id(atom.predicate->name));
+        for (const Object &object : atom.objects) {
+          ret.objects.push_back(get_object_id(object));
+        }
+        ret.offsets.push_back(ret.objects.size());
+      }
+      return ret;
+    }
+
+    Atom SymbolTable::unpack(const PackedAtoms &atoms, size_t i) const {
+      std::vector<Object> atom_objects;
+      atom_objects.reserve(atoms.get_arity(i));
+      for (int r = atoms.offsets[i]; r < atoms.offsets[i + 1]; r++) {
+        atom_objects.push_back(objects.at(atoms.objects[r]));
+      }
+      return Atom(predicates.at(atoms.predicates[i]), atom_objects);
+    }
+
+    void SymbolTable::check_packed(const PackedAtoms &atoms) const {
+      if (atoms.offsets.size() != atoms.predicates.size() + 1 || atoms.offsets[0] != 0 ||
+          atoms.offsets.back() != (int)atoms.objects.size()) {
+        throw std::runtime_error("Packed atoms need one more offset than predicates, starting at 0 "
+                                 "and ending at the number of objects");
+      }
+      // together with the first and last offsets, this keeps all offsets in range
+      if (!std::is_sorted(atoms.offsets.begin(), atoms.offsets.end())) {
+        throw std::runtime_error("Packed atom offsets must be non-decreasing");
+      }
+      for (size_t i = 0; i < atoms.size(); i++) {
+        int predicate = atoms.predicates[i];
+        if (predicate < 0 || predicate >= get_n_predicates()) {
+          throw std::runtime_error("Unknown predicate id " + std::to_string(predicate));
+        }
+        if (atoms.get_arity(i) != predicates[predicate].arity) {
+          throw std::runtime_error("Arity mismatch for packed atom " + std::to_string(i) +
+                                   " of predicate " + predicates[predicate].name);
+        }
+        for (int r = atoms.offsets[i]; r < atoms.offsets[i + 1]; r++) {
+          if (atoms.objects[r] < 0 || atoms.objects[r] >= get_n_objects()) {
+            throw std::runtime_error("Unknown object id " + std::to_string(atoms.objects[r]));
+          }
+        }
+      }
+    }
+
+    uint64_t SymbolTable::name_hash(const std::string &name) {
+      return utils::mix64(std::hash<std::string>()(name));
+    }
+
+    uint64_t SymbolTable::atom_key(const Atom &atom) {
+      uint64_t key = name_hash(atom.predicate->name);
+      for (const Object &object : atom.objects) {
+        key = utils::mix64(key ^ name_hash(object));
+      }
+      return key;
+    }
+
+    uint64_t SymbolTable::atom_key(const PackedAtoms &atoms, size_t i) const {
+      uint64_t key = predicate_hashes[atoms.predicates[i]];
+      for (int r = atoms.offsets[i]; r < atoms.offsets[i + 1]; r++) {
+        key = utils::mix64(key ^ object_hashes[atoms.objects[r]]);
+      }
+      return key;
+    }
+  }  // namespace planning
+}  // namespace wlplan
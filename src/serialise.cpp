@@ -1,8 +1,11 @@
 #include "../include/serialise.hpp"
 
+#include "../include/data/columnar_dataset.hpp"
 #include "../include/data/dataset.hpp"
+#include "../include/feature_generator/feature_generator_loader.hpp"
 #include "../include/planning/action.hpp"
 #include "../include/planning/atom.hpp"
+#include "../include/planning/binary_format.hpp"
 #include "../include/planning/domain.hpp"
 #include "../include/planning/fluent.hpp"
 #include "../include/planning/function.hpp"
@@ -12,7 +15,10 @@
 #include "../include/planning/problem.hpp"
 #include "../include/planning/schema.hpp"
 #include "../include/planning/state.hpp"
-#include "../include/utils/exceptions.hpp"
+#include "../include/planning/symbol_table.hpp"
+#include "../include/utils/binary_io.hpp"
+
+#include <pybind11/numpy.h>
 
 using namespace wlplan;
 
@@ -87,8 +93,12 @@ planning::Atom __setstate__(py::tuple t) {
 // Domain
 template <>
 py::tuple __getstate__(const planning::Domain &input) {
-  return py::make_tuple(
-      input.name, input.predicates, input.functions, input.schemata, input.constant_objects);
+  // predicates in colour order, as the domain gives colours in the order of its input
+  return py::make_tuple(input.name,
+                        input.get_predicates_by_colour(),
+                        input.functions,
+                        input.schemata,
+                        input.constant_objects);
 }
 
 template <>
@@ -129,12 +139,16 @@ planning::Function __setstate__(py::tuple t) {
 // NumericCondition
 template <>
 py::tuple __getstate__(const planning::NumericCondition &input) {
-  throw NotImplementedError("NumericCondition serialisation");
+  std::string buffer;
+  utils::BinaryWriter writer(buffer);
+  planning::write_numeric_condition(writer, input);
+  return py::make_tuple(py::bytes(buffer));
 }
 
 template <>
 planning::NumericCondition __setstate__(py::tuple t) {
-  throw NotImplementedError("NumericCondition serialisation");
+  check_state_validity(t, "NumericCondition", 1);
+  return __from_buffer__<planning::NumericCondition>(t[0].cast<py::buffer>());
 }
 
 // Predicate
@@ -187,6 +201,27 @@ planning::Schema __setstate__(py::tuple t) {
   return planning::Schema(t[0].cast<std::string>(), t[1].cast<int>());
 }
 
+// SymbolTable
+template <>
+py::tuple __getstate__(const planning::SymbolTable &input) {
+  std::string buffer;
+  utils::BinaryWriter writer(buffer);
+  planning::write_symbol_table(writer, input);
+  return py::make_tuple(py::bytes(buffer));
+}
+
+template <>
+planning::SymbolTable __setstate__(py::tuple t) {
+  check_state_validity(t, "SymbolTable", 1);
+  py::buffer_info info = t[0].cast<py::buffer>().request();
+  utils::BinaryReader reader(static_cast<const char *>(info.ptr), info.size * info.itemsize);
+  std::shared_ptr<const planning::SymbolTable> ret = planning::read_symbol_table(reader);
+  if (!reader.done()) {
+    throw std::runtime_error("Invalid state for SymbolTable: trailing bytes");
+  }
+  return *ret;
+}
+
 // State
 template <>
 py::tuple __getstate__(const planning::State &input) {
@@ -199,3 +234,162 @@ planning::State __setstate__(py::tuple t) {
   return planning::State(t[0].cast<std::vector<planning::Atom>>(),
                          t[1].cast<std::vector<double>>());
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// Binary buffers
+//////////////////////////////////////////////////////////////////////////////
+
+void write_binary(utils::BinaryWriter &writer, const planning::NumericCondition &input) {
+  planning::write_numeric_condition(writer, input);
+}
+
+void write_binary(utils::BinaryWriter &writer, const planning::Problem &input) {
+  planning::write_domain(writer, input.get_domain());
+  planning::write_problem(writer, input);
+}
+
+void write_binary(utils::BinaryWriter &writer, const data::DomainDataset &input) {
+  data::ColumnarDataset(input).write(writer);
+}
+
+void write_binary(utils::BinaryWriter &writer, const data::ProblemDataset &input) {
+  data::ColumnarDataset(data::DomainDataset(input.problem.get_domain(), {input})).write(writer);
+}
+
+void write_binary(utils::BinaryWriter &writer, const feature_generator::Features &input) {
+  input.write(writer);
+}
+
+template <typename T>
+T read_binary(utils::BinaryReader &reader);
+
+template <>
+planning::NumericCondition read_binary<planning::NumericCondition>(utils::BinaryReader &reader) {
+  return planning::read_numeric_condition(reader);
+}
+
+template <>
+planning::Problem read_binary<planning::Problem>(utils::BinaryReader &reader) {
+  auto domain = std::make_shared<const planning::Domain>(planning::read_domain(reader));
+  return planning::read_problem(reader, domain);
+}
+
+template <>
+data::DomainDataset read_binary<data::DomainDataset>(utils::BinaryReader &reader) {
+  return data::ColumnarDataset::read(reader).to_domain_dataset();
+}
+
+template <>
+data::ProblemDataset read_binary<data::ProblemDataset>(utils::BinaryReader &reader) {
+  data::ColumnarDataset dataset = data::ColumnarDataset::read(reader);
+  if (dataset.get_n_problems() != 1) {
+    throw std::runtime_error("Invalid buffer for ProblemDataset: expected 1 problem, got " +
+                             std::to_string(dataset.get_n_problems()));
+  }
+  return dataset.get_problem_dataset(0);
+}
+
+template <>
+std::unique_ptr<feature_generator::Features>
+read_binary<std::unique_ptr<feature_generator::Features>>(utils::BinaryReader &reader) {
+  return read_feature_generator(reader);
+}
+
+// the pickled form of a buffer, which is owned by the result
+py::object to_pickle_data(std::unique_ptr<std::string> buffer, int protocol) {
+  py::object data;
+  if (protocol >= 5) {
+    // a read only array that owns the buffer, so that pickle can use it without a copy
+    std::string *raw = buffer.release();
+    py::capsule owner(raw, [](void *ptr) { delete static_cast<std::string *>(ptr); });
+    py::array_t<uint8_t> array(
+        {raw->size()}, {1}, reinterpret_cast<const uint8_t *>(raw->data()), owner);
+    array.attr("flags").attr("writeable") = false;
+    data = py::module_::import("pickle").attr("PickleBuffer")(array);
+  } else {
+    data = py::bytes(*buffer);
+  }
+  return data;
+}
+
+template <typename T>
+py::tuple __reduce_ex__(const T &input, int protocol, const py::object &from_buffer) {
+  auto buffer = std::make_unique<std::string>();
+  {
+    py::gil_scoped_release release;
+    utils::BinaryWriter writer(*buffer);
+    write_binary(writer, input);
+  }
+  return py::make_tuple(from_buffer, py::make_tuple(to_pickle_data(std::move(buffer), protocol)));
+}
+
+// reads T from a contiguous buffer with the GIL released
+template <typename T, typename Read>
+T read_pickle_buffer(const py::buffer &buffer, Read read) {
+  py::buffer_info info = buffer.request();
+  if (info.ndim > 1 || (info.ndim == 1 && info.strides[0] != info.itemsize)) {
+    throw std::runtime_error("Pickled buffer is not contiguous");
+  }
+  const char *data = static_cast<const char *>(info.ptr);
+  size_t size = info.size * info.itemsize;
+
+  py::gil_scoped_release release;
+  utils::BinaryReader reader(data, size);
+  T ret = read(reader);
+  if (!reader.done()) {
+    throw std::runtime_error("Pickled buffer has trailing bytes");
+  }
+  return ret;
+}
+
+template <typename T>
+T __from_buffer__(const py::buffer &buffer) {
+  return read_pickle_buffer<T>(buffer, read_binary<T>);
+}
+
+py::tuple
+__reduce_ex__(const planning::State &input, int protocol, const py::object &from_buffer) {
+  std::shared_ptr<const planning::SymbolTable> symbol_table =
+      planning::get_state_symbol_table(input);
+  auto buffer = std::make_unique<std::string>();
+  {
+    py::gil_scoped_release release;
+    utils::BinaryWriter writer(*buffer);
+    planning::write_state(writer, input, *symbol_table);
+  }
+
+  // the same table object is returned for states sharing a table, so that pickle memoises it
+  py::object table = py::cast(std::const_pointer_cast<planning::SymbolTable>(symbol_table));
+  return py::make_tuple(from_buffer,
+                        py::make_tuple(table, to_pickle_data(std::move(buffer), protocol)));
+}
+
+planning::State
+__state_from_buffer__(const std::shared_ptr<planning::SymbolTable> &symbol_table,
+                      const py::buffer &buffer) {
+  if (!symbol_table) {
+    throw std::runtime_error("Pickled state has no symbol table");
+  }
+  return read_pickle_buffer<planning::State>(buffer, [&](utils::BinaryReader &reader) {
+    return planning::read_state(reader, symbol_table);
+  });
+}
+
+template py::tuple __reduce_ex__(const planning::NumericCondition &input,
+                                 int protocol,
+                                 const py::object &from_buffer);
+template py::tuple
+__reduce_ex__(const planning::Problem &input, int protocol, const py::object &from_buffer);
+template py::tuple
+__reduce_ex__(const data::DomainDataset &input, int protocol, const py::object &from_buffer);
+template py::tuple
+__reduce_ex__(const data::ProblemDataset &input, int protocol, const py::object &from_buffer);
+template py::tuple __reduce_ex__(const feature_generator::Features &input,
+                                 int protocol,
+                                 const py::object &from_buffer);
+
+template planning::NumericCondition __from_buffer__(const py::buffer &buffer);
+template planning::Problem __from_buffer__(const py::buffer &buffer);
+template data::DomainDataset __from_buffer__(const py::buffer &buffer);
+template data::ProblemDataset __from_buffer__(const py::buffer &buffer);
+template std::unique_ptr<feature_generator::Features> __from_buffer__(const py::buffer &buffer);
@@ -1,11 +1,12 @@
 import logging
 import os
+import random
 import zipfile
 
 import pymimir
 
 from wlplan.data import DomainDataset, ProblemDataset
-from wlplan.planning import parse_domain, parse_problem
+from wlplan.planning import State, parse_domain, parse_problem
 
 
 LOGGER = logging.getLogger(__name__)
@@ -61,6 +62,22 @@ def get_domain_problem(domain_name: str, problem_name: str):
     return domain, problem
 
 
+def get_random_walk(domain_name: str, n_states: int = 20, seed: int = 0):
+    """States of problem 0_01 over subsets of its goal atoms. Each state after the first changes
+    the values of a random half of the fluents of the previous state."""
+    domain, problem = get_domain_problem(domain_name, problem_name="0_01")
+    rng = random.Random(seed)
+    values = list(problem.init_fluent_values)
+    states = []
+    for i in range(n_states):
+        if i > 0:
+            for j in rng.sample(range(len(values)), len(values) // 2):
+                values[j] += rng.randint(1, 3)
+        atoms = [goal for goal in problem.positive_goals if rng.random() < 0.5]
+        states.append(State(atoms, list(values)))
+    return domain, problem, states
+
+
 def get_predicates(mimir_domain: pymimir.Domain, keep_statics: bool):
     raise NotImplementedError
 
@@ -0,0 +1,127 @@
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from neurips24 import DOMAINS as NEURIPS24_DOMAINS, get_random_walk
+
+from wlplan.data import DomainDataset, ProblemDataset
+from wlplan.feature_generator import init_feature_generator, load_feature_generator
+
+
+# classical domains have no continuous features, unlike the numeric neurips24 domains
+DOMAINS = [("ipc23lt", "blocksworld"), ("ipc23lt", "ferry")] + [
+    ("neurips24", domain_name) for domain_name in sorted(NEURIPS24_DOMAINS)
+]
+
+
+def densify(X_sparse, n_features):
+    X = np.zeros((len(X_sparse), n_features))
+    for row, x in enumerate(X_sparse):
+        for index, value in x:
+            X[row, index] = value
+    return X
+
+
+def predict_all(feature_generator, dataset):
+    ret = []
+    for data in dataset.data:
+        feature_generator.set_problem(data.problem)
+        ret.extend(feature_generator.predict(state) for state in data.states)
+    return np.array(ret)
+
+
+def get_domain_dataset(benchmark, domain_name):
+    if benchmark == "ipc23lt":
+        domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+        return domain, dataset, "ilg"
+    domain, problem, states = get_random_walk(domain_name)
+    dataset = DomainDataset(domain=domain, data=[ProblemDataset(problem=problem, states=states)])
+    return domain, dataset, "nilg"
+
+
+def active_pairs(feature_generator, dataset):
+    """Pairs of continuous features with a non-zero pair feature in some state"""
+    n_colours = feature_generator.get_n_colours()
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    con = X[:, n_colours : 2 * n_colours]
+    ret = []
+    for i in range(n_colours):
+        for j in range(n_colours):
+            if i != j and ((con[:, i] > con[:, j]) & (con[:, j] != 0)).any():
+                ret.append((i, j))
+    return ret
+
+
+def collect(benchmark, domain_name, pairs):
+    domain, dataset, graph_representation = get_domain_dataset(benchmark, domain_name)
+    feature_generator = init_feature_generator(
+        feature_algorithm="ccwl-a",
+        domain=domain,
+        graph_representation=graph_representation,
+        iterations=2,
+    )
+    feature_generator.collect(dataset)
+    if pairs:
+        n_colours = feature_generator.get_n_colours()
+        selected = active_pairs(feature_generator, dataset)[:20]
+        selected += [(i, (i * 7 + 1) % n_colours) for i in range(n_colours)]
+        selected = list(dict.fromkeys((i, j) for i, j in selected if i != j))
+        feature_generator.set_selected_pairs(selected)
+    return feature_generator, dataset
+
+
+def check_pair_features(feature_generator, benchmark, X):
+    if benchmark == "neurips24":
+        n_colours = feature_generator.get_n_colours()
+        assert (X[:, 2 * n_colours :] != 0).any(), "numeric domains should have pair features"
+
+
+@pytest.mark.parametrize("benchmark,domain_name", DOMAINS)
+@pytest.mark.parametrize("pairs", [False, True])
+def test_sparse_embedding(benchmark, domain_name, pairs):
+    feature_generator, dataset = collect(benchmark, domain_name, pairs)
+    n_features = feature_generator.get_n_features()
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    assert X.shape[1] == n_features
+    check_pair_features(feature_generator, benchmark, X)
+    X_sparse = feature_generator.embed_sparse(dataset)
+    assert (densify(X_sparse, n_features) == X).all()
+
+
+@pytest.mark.parametrize("benchmark,domain_name", DOMAINS)
+@pytest.mark.parametrize("pairs", [False, True])
+def test_predict(benchmark, domain_name, pairs):
+    feature_generator, dataset = collect(benchmark, domain_name, pairs)
+    n_features = feature_generator.get_n_features()
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    check_pair_features(feature_generator, benchmark, X)
+    rng = np.random.default_rng(0)
+    weights = rng.normal(size=n_features)
+
+    feature_generator.set_weights(weights.tolist())
+    assert np.allclose(predict_all(feature_generator, dataset), X @ weights)
+
+    # most pair weights are zero after sparse training, so keep those of non-zero pair features
+    n_colours = feature_generator.get_n_colours()
+    pair_columns = np.flatnonzero((X[:, 2 * n_colours :] != 0).any(axis=0)) + 2 * n_colours
+    sparse = rng.choice(n_features, size=min(n_features, 50), replace=False)
+    sparse = np.union1d(sparse, pair_columns[:20])
+    feature_generator.set_sparse_weights([(int(i), float(weights[i])) for i in sparse])
+    sparse_weights = np.zeros(n_features)
+    sparse_weights[sparse] = weights[sparse]
+    assert np.allclose(predict_all(feature_generator, dataset), X @ sparse_weights)
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld"])
+def test_save_load_selected_pairs(domain_name, tmp_path):
+    feature_generator, dataset = collect("ipc23lt", domain_name, pairs=True)
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    weights = np.arange(feature_generator.get_n_features(), dtype=float)
+    feature_generator.set_weights(weights.tolist())
+    save_file = str(tmp_path / "ccwla.json")
+    feature_generator.save(save_file)
+
+    loaded = load_feature_generator(save_file, quiet=True)
+    assert loaded.get_selected_pairs() == feature_generator.get_selected_pairs()
+    assert loaded.get_n_features() == feature_generator.get_n_features()
+    assert (np.array(loaded.embed(dataset)).astype(float) == X).all()
+    assert np.allclose(predict_all(loaded, dataset), X @ weights)
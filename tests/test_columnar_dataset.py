@@ -0,0 +1,46 @@
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from util import init_ilg_features
+
+from wlplan.data import ColumnarDataset
+
+
+LOGGER = logging.getLogger(__name__)
+
+DOMAINS = ["blocksworld", "childsnack", "ferry"]
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+def test_save_load(domain_name, tmp_path):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    columnar = ColumnarDataset(dataset)
+    path = str(tmp_path / "dataset.bin")
+    columnar.save(path)
+    loaded = ColumnarDataset.load(path)
+
+    assert loaded.domain == domain
+    assert loaded.n_problems == len(dataset.data)
+    assert len(loaded) == sum(len(data.states) for data in dataset.data)
+    for i, data in enumerate(dataset.data):
+        states = loaded.get_states(i)
+        assert len(states) == len(data.states)
+        for j, state in enumerate(data.states):
+            assert states[j] == state
+            assert loaded.get_state(i, j) == state
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+def test_same_features(domain_name, tmp_path):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    path = str(tmp_path / "dataset.bin")
+    ColumnarDataset(dataset).save(path)
+    loaded = ColumnarDataset.load(path).to_domain_dataset()
+
+    feature_generator = init_ilg_features(domain)
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset))
+    X_loaded = np.array(feature_generator.embed(loaded))
+    assert np.array_equal(X, X_loaded)
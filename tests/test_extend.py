@@ -0,0 +1,38 @@
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from util import init_ilg_features
+
+from wlplan.data import DomainDataset
+
+
+LOGGER = logging.getLogger(__name__)
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld", "childsnack", "ferry"])
+@pytest.mark.parametrize("feature_algorithm", ["wl", "lwl2"])
+def test_extend(domain_name: str, feature_algorithm: str):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    half = len(dataset.data) // 2
+    dataset_1 = DomainDataset(domain=domain, data=dataset.data[:half])
+    dataset_2 = DomainDataset(domain=domain, data=dataset.data[half:])
+
+    feature_generator = init_ilg_features(domain, feature_algorithm)
+    feature_generator.collect(dataset_1)
+    n_colours = feature_generator.get_n_colours()
+    X_1 = np.array(feature_generator.embed(dataset))
+
+    new_colours = feature_generator.extend(dataset_2)
+    LOGGER.info(f"{n_colours=}, {len(new_colours)=}")
+    assert new_colours == list(range(n_colours, feature_generator.get_n_colours()))
+
+    # existing columns keep their meaning
+    X_2 = np.array(feature_generator.embed(dataset))
+    assert (X_2[:, :n_colours] == X_1).all()
+
+    # the same colours are collected as with all data at once, up to their ids
+    full_generator = init_ilg_features(domain, feature_algorithm)
+    full_generator.collect(dataset)
+    assert full_generator.get_n_colours() == feature_generator.get_n_colours()
@@ -5,8 +5,13 @@ import networkx as nx
 import numpy as np
 import pytest
 from ipc23lt import get_domain_pddl, get_raw_dataset as get_ipc23lt_dataset
-from neurips24 import get_raw_dataset as get_neurips24_dataset
+from neurips24 import (
+    DOMAINS as NEURIPS24_DOMAINS,
+    get_random_walk,
+    get_raw_dataset as get_neurips24_dataset,
+)
 
+from wlplan.data import DomainDataset, ProblemDataset
 from wlplan.feature_generator import init_feature_generator
 from wlplan.graph_generator import (
     IILGGenerator,
@@ -16,7 +21,7 @@ from wlplan.graph_generator import (
     from_networkx,
     to_networkx,
 )
-from wlplan.planning import parse_domain
+from wlplan.planning import State, parse_domain
 
 
 LOGGER = logging.getLogger(__name__)
@@ -93,6 +98,29 @@ def test_nilg():
             assert nx_graph is not None
 
 
+@pytest.mark.parametrize("domain_name", sorted(NEURIPS24_DOMAINS))
+def test_nilg_incremental_numerics(domain_name):
+    """Embeddings from updating the numeric nodes of one graph match those of fresh graphs"""
+    domain, problem, states = get_random_walk(domain_name)
+    feature_generator = init_feature_generator(
+        feature_algorithm="ccwl", domain=domain, graph_representation="nilg", iterations=2
+    )
+    dataset = DomainDataset(domain=domain, data=[ProblemDataset(problem=problem, states=states)])
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    assert (np.array(feature_generator.embed_problem(problem, states)).astype(float) == X).all()
+
+    weights = np.random.default_rng(0).normal(size=X.shape[1])
+    feature_generator.set_weights(weights.tolist())
+    feature_generator.set_problem(problem)
+    y = [feature_generator.predict(state) for state in states]
+    assert np.allclose(y, X @ weights)
+
+    values = problem.init_fluent_values + [0.0]
+    with pytest.raises(RuntimeError):
+        feature_generator.embed_problem(problem, [State(states[0].atoms, values)])
+
+
 def test_ploig():
     """Test PLOIG generator does not crash"""
     domain, dataset, _ = get_ipc23lt_dataset(domain_name="blocksworld", keep_statics=False)
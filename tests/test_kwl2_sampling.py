@@ -0,0 +1,68 @@
+import json
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from util import init_ilg_features
+
+
+LOGGER = logging.getLogger(__name__)
+
+
+@pytest.mark.parametrize("domain_name", ["childsnack"])
+def test_sampled_kwl2(domain_name):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+
+    exact = init_ilg_features(domain, "kwl2", iterations=1)
+    exact.collect(dataset)
+    X = np.array(exact.embed(dataset)).astype(float)
+
+    # a budget that covers every graph is equivalent to no sampling
+    unbounded = init_ilg_features(domain, "kwl2", iterations=1)
+    unbounded.set_sampling(budget=10**12, seed=0)
+    unbounded.collect(dataset)
+    assert (np.array(unbounded.embed(dataset)).astype(float) == X).all()
+
+    sampled = init_ilg_features(domain, "kwl2", iterations=1)
+    sampled.set_sampling(budget=1000, seed=0)
+    sampled.collect(dataset)
+    X_1 = np.array(sampled.embed(dataset)).astype(float)
+    X_2 = np.array(sampled.embed(dataset)).astype(float)
+    LOGGER.info(f"{exact.get_n_features()=}, {sampled.get_n_features()=}")
+
+    # sampling is deterministic and each layer is reweighted to the number of pairs
+    assert (X_1 == X_2).all()
+    assert np.allclose(X_1.sum(axis=1), X.sum(axis=1))
+
+
+def _totals_by_colour(feature_generator, dataset, path):
+    """Sums the embeddings of a dataset per initial 2-KWL colour, keyed independently of ids."""
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    feature_generator.save(path)
+    with open(path) as f:
+        colour_hash = json.load(f)["colour_hash"][0]
+    return {key: X[:, i].sum() for key, i in colour_hash.items()}
+
+
+@pytest.mark.parametrize("domain_name", ["childsnack"])
+def test_sampled_kwl2_unbiased(domain_name, tmp_path):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    path = str(tmp_path / "kwl2.json")
+
+    exact = _totals_by_colour(init_ilg_features(domain, "kwl2", iterations=0), dataset, path)
+
+    n_seeds = 100
+    mean = {key: 0.0 for key in exact}
+    for seed in range(n_seeds):
+        sampled = init_ilg_features(domain, "kwl2", iterations=0)
+        sampled.set_sampling(budget=1000, seed=seed)
+        for key, total in _totals_by_colour(sampled, dataset, path).items():
+            assert key in exact, "sampling only sees pairs of the graph"
+            mean[key] += total / n_seeds
+
+    # expected counts match the exact counts for diagonal and off-diagonal pairs alike
+    error = sum(abs(mean[key] - exact[key]) for key in exact)
+    LOGGER.info(f"relative error {error / sum(exact.values())}")
+    assert error < 0.05 * sum(exact.values())
@@ -0,0 +1,49 @@
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from util import init_ilg_features
+
+from wlplan.data import DomainDataset
+from wlplan.feature_generator import merge_feature_generators
+
+
+LOGGER = logging.getLogger(__name__)
+
+DOMAINS = ["blocksworld", "childsnack", "ferry"]
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+@pytest.mark.parametrize("multiset_hash", [False, True])
+def test_merge(domain_name: str, multiset_hash: bool):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    n_shards = 3
+    shards = [
+        DomainDataset(domain=domain, data=dataset.data[i::n_shards]) for i in range(n_shards)
+    ]
+
+    save_files = []
+    shard_X = []
+    for i, shard in enumerate(shards):
+        feature_generator = init_ilg_features(domain, iterations=3, multiset_hash=multiset_hash)
+        feature_generator.collect(shard)
+        shard_X.append(np.array(feature_generator.embed(dataset)))
+        save_file = f"tests/models/merge/{domain_name}_{multiset_hash}_{i}.json"
+        feature_generator.save(save_file)
+        save_files.append(save_file)
+
+    merged, remaps = merge_feature_generators(save_files)
+    merged_reversed, _ = merge_feature_generators(save_files[::-1])
+    X = np.array(merged.embed(dataset))
+
+    # the merged colours are those collected on all data, numbered independently of the order
+    full_generator = init_ilg_features(domain, iterations=3, multiset_hash=multiset_hash)
+    full_generator.collect(dataset)
+    assert merged.get_n_colours() == full_generator.get_n_colours()
+    assert (np.array(merged_reversed.embed(dataset)) == X).all()
+
+    # shard embeddings can be translated to merged embeddings
+    for X_i, remap in zip(shard_X, remaps):
+        old, new = zip(*remap.items())
+        assert (X_i[:, list(old)] == X[:, list(new)]).all()
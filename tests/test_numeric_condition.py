@@ -0,0 +1,74 @@
+import numpy as np
+import pytest
+from neurips24 import DOMAINS as NEURIPS24_DOMAINS, get_domain_problem
+
+from wlplan.planning import (
+    ComparatorType,
+    ConstantExpression,
+    FluentExpression,
+    FormulaExpression,
+    NumericCondition,
+    OperatorType,
+)
+
+
+def get_expression():
+    # ((x - 2 * 1.5) * y) / (z + 1) with a constant subexpression
+    x = FluentExpression(0, "x")
+    y = FluentExpression(1, "y")
+    z = FluentExpression(2, "z")
+    two_by_one_and_half = FormulaExpression(
+        OperatorType.Multiply, ConstantExpression(2), ConstantExpression(1.5)
+    )
+    lhs = FormulaExpression(
+        OperatorType.Multiply, FormulaExpression(OperatorType.Minus, x, two_by_one_and_half), y
+    )
+    rhs = FormulaExpression(OperatorType.Plus, z, ConstantExpression(1))
+    return FormulaExpression(OperatorType.Divide, lhs, rhs)
+
+
+def expected_formula_and_error(comparator_type, value):
+    if comparator_type == ComparatorType.GreaterThan:
+        return value > 0, max(value, 0.0)
+    elif comparator_type == ComparatorType.GreaterThanOrEqual:
+        return value >= 0, max(value, 0.0)
+    else:
+        return value == 0, abs(value)
+
+
+@pytest.mark.parametrize(
+    "comparator_type",
+    [ComparatorType.GreaterThan, ComparatorType.GreaterThanOrEqual, ComparatorType.Equal],
+)
+def test_numeric_condition(comparator_type):
+    expression = get_expression()
+    condition = NumericCondition(comparator_type, expression)
+
+    rng = np.random.default_rng(0)
+    values = rng.integers(-4, 5, size=(3, 100)).astype(float)
+    values[2, values[2] == -1] = 0  # z + 1 != 0
+    formulas, errors = condition.evaluate_batch(values)
+    for i in range(values.shape[1]):
+        state_values = list(values[:, i])
+        value = expression.evaluate(state_values)
+        formula, error = condition.evaluate_formula_and_error(state_values)
+        assert (formula, error) == expected_formula_and_error(comparator_type, value)
+        assert formulas[i] == formula
+        assert errors[i] == error
+
+
+@pytest.mark.parametrize("domain_name", sorted(NEURIPS24_DOMAINS))
+def test_numeric_goals(domain_name):
+    _, problem = get_domain_problem(domain_name, problem_name="0_01")
+    init_values = np.array(problem.init_fluent_values, dtype=float)
+
+    # states around the initial state
+    rng = np.random.default_rng(0)
+    values = init_values[:, None] + rng.integers(-3, 4, size=(len(init_values), 100))
+    for goal in problem.numeric_goals:
+        formulas, errors = goal.evaluate_batch(values)
+        for i in range(values.shape[1]):
+            value = goal.expression.evaluate(list(values[:, i]))
+            formula, error = expected_formula_and_error(goal.comparator_type, value)
+            assert formulas[i] == formula
+            assert errors[i] == error or (np.isnan(errors[i]) and np.isnan(error))
@@ -0,0 +1,126 @@
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_raw_dataset
+from util import init_ilg_features
+
+from wlplan.data import DomainDataset, ProblemDataset
+from wlplan.planning import State, states_from_arrays
+
+
+LOGGER = logging.getLogger(__name__)
+
+DOMAINS = ["blocksworld", "childsnack", "ferry"]
+
+
+def to_arrays(problem, states):
+    predicate_to_id = problem.predicate_to_id
+    object_to_id = problem.object_to_id
+    predicates, objects, atom_offsets, state_offsets = [], [], [0], [0]
+    for state in states:
+        for atom in state.atoms:
+            predicates.append(predicate_to_id[atom.predicate.name])
+            objects.extend(object_to_id[o] for o in atom.objects)
+            atom_offsets.append(len(objects))
+        state_offsets.append(len(predicates))
+    return [np.array(x, dtype=np.int32) for x in [predicates, objects, atom_offsets, state_offsets]]
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+def test_packed_states(domain_name: str):
+    domain, data, _ = get_raw_dataset(domain_name, keep_statics=False)
+
+    packed_data = []
+    for problem, states in data:
+        predicates, objects, atom_offsets, state_offsets = to_arrays(problem, states)
+        packed_states = states_from_arrays(
+            problem, predicates, objects, atom_offsets, state_offsets
+        )
+        assert len(packed_states) == len(states)
+        for state, packed_state in zip(states, packed_states):
+            assert packed_state.is_packed
+            assert repr(packed_state) == repr(state)
+
+        # single states from slices
+        start, end = state_offsets[0], state_offsets[1]
+        state = State(
+            problem,
+            predicates[start:end],
+            objects[atom_offsets[start] : atom_offsets[end]],
+            atom_offsets[start : end + 1] - atom_offsets[start],
+        )
+        assert repr(state) == repr(states[0])
+        packed_data.append(ProblemDataset(problem, packed_states))
+
+    dataset = DomainDataset(domain, [ProblemDataset(p, s) for p, s in data])
+    packed_dataset = DomainDataset(domain, packed_data)
+
+    feature_generator = init_ilg_features(domain)
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset))
+    X_packed = np.array(feature_generator.embed(packed_dataset))
+    assert (X == X_packed).all()
+
+
+def test_bad_packed_state():
+    domain, data, _ = get_raw_dataset("blocksworld", keep_statics=False)
+    problem = data[0][0]
+    n_objects = len(problem.object_to_id)
+    with pytest.raises(RuntimeError):
+        State(problem, np.array([0]), np.array([n_objects]), np.array([0, 1]))
+    with pytest.raises(RuntimeError):
+        State(problem, np.array([0]), np.array([]), np.array([0]))
+
+    # offsets that leave the objects array in the middle
+    on = problem.predicate_to_id["on"]
+    predicates = np.array([on, on])
+    objects = np.array([0, 1, 1])
+    with pytest.raises(RuntimeError):
+        State(problem, predicates, objects, np.array([0, 10**9, 3]))
+    for atom_offsets, state_offsets in [([0, 10**9, 3], [0, 2]), ([0, 2, 3], [0, 10**9, 2])]:
+        with pytest.raises(RuntimeError):
+            states_from_arrays(
+                problem, predicates, objects, np.array(atom_offsets), np.array(state_offsets)
+            )
+
+
+def test_packed_state_of_other_problem():
+    domain, data, _ = get_raw_dataset("blocksworld", keep_statics=False)
+    problem, states = data[0]
+    other_problem, other_states = next(
+        (p, s) for p, s in data if len(p.object_to_id) != len(problem.object_to_id)
+    )
+    other_packed = states_from_arrays(other_problem, *to_arrays(other_problem, other_states))
+
+    feature_generator = init_ilg_features(domain)
+    feature_generator.collect(DomainDataset(domain, [ProblemDataset(problem, states)]))
+    feature_generator.set_problem(problem)
+    packed = states_from_arrays(problem, *to_arrays(problem, states))
+    assert feature_generator.embed(packed[0]) == feature_generator.embed(states[0])
+
+    # ids of packed atoms only make sense with the symbols of their own problem
+    with pytest.raises(RuntimeError):
+        feature_generator.embed(other_packed[0])
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+def test_state_hash(domain_name: str):
+    _, data, _ = get_raw_dataset(domain_name, keep_statics=False)
+
+    for problem, states in data:
+        packed_states = states_from_arrays(problem, *to_arrays(problem, states))
+        for state, packed_state in zip(states, packed_states):
+            reordered = State(list(reversed(state.atoms)))
+            assert state == reordered and hash(state) == hash(reordered)
+            assert state == packed_state and hash(state) == hash(packed_state)
+        assert len(set(states)) == len(set(repr(s) for s in states))
+
+        # successors along the plan trace
+        for state, next_state in zip(states, states[1:]):
+            next_atoms = set(repr(a) for a in next_state.atoms)
+            atoms = set(repr(a) for a in state.atoms)
+            add_atoms = [a for a in next_state.atoms if repr(a) not in atoms]
+            delete_atoms = [a for a in state.atoms if repr(a) not in next_atoms]
+            successor = state.successor(add_atoms, delete_atoms)
+            assert successor == next_state and hash(successor) == hash(next_state)
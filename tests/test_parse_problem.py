@@ -1,9 +1,12 @@
 import logging
 
+import ipc23lt
+import neurips24
+import pddl
 import pytest
 from ipc23lt import DOMAINS, get_domain_pddl, get_problem_pddl
 
-from wlplan.planning import parse_problem
+from wlplan.planning import parse_problem, parse_problems, to_wlplan_problem
 
 
 LOGGER = logging.getLogger(__name__)
@@ -15,3 +18,45 @@ def test_profile(domain_name):
     domain_pddl = get_domain_pddl(domain_name)
     problem = parse_problem(domain_pddl, problem_pddl)
     LOGGER.info(problem)
+
+
+BENCHMARKS = [(ipc23lt, d) for d in sorted(ipc23lt.DOMAINS)] + [
+    (neurips24, d) for d in sorted(neurips24.DOMAINS)
+]
+
+
+@pytest.mark.parametrize(
+    "benchmark,domain_name", BENCHMARKS, ids=[f"{b.__name__}-{d}" for b, d in BENCHMARKS]
+)
+def test_matches_pddl_package(benchmark, domain_name):
+    problem_pddl = benchmark.get_problem_pddl(domain_name, "0_01")
+    domain_pddl = benchmark.get_domain_pddl(domain_name)
+    for keep_statics in [True, False]:
+        problem = parse_problem(domain_pddl, problem_pddl, keep_statics=keep_statics)
+        expected = to_wlplan_problem(
+            pddl.parse_domain(domain_pddl), pddl.parse_problem(problem_pddl), keep_statics
+        )
+        assert problem.domain == expected.domain
+        assert problem.objects == expected.objects
+        for goals in ["positive_goals", "negative_goals"]:
+            actual_goals = sorted(repr(g) for g in getattr(problem, goals))
+            assert actual_goals == sorted(repr(g) for g in getattr(expected, goals))
+
+        # fluent ids are used by numeric goals and features, so their order must match too
+        assert [repr(f) for f in problem.fluents] == [repr(f) for f in expected.fluents]
+        assert problem.init_fluent_values == expected.init_fluent_values
+        assert len(problem.numeric_goals) == len(expected.numeric_goals)
+        for goal, expected_goal in zip(problem.numeric_goals, expected.numeric_goals):
+            assert goal.comparator_type == expected_goal.comparator_type
+            assert repr(goal.expression) == repr(expected_goal.expression)
+            assert goal.expression.get_fluent_ids() == expected_goal.expression.get_fluent_ids()
+
+
+@pytest.mark.parametrize("domain_name", sorted(DOMAINS))
+def test_parse_problems(domain_name):
+    problem_names = ["0_01", "0_02", "0_03"]
+    problem_pddls = [get_problem_pddl(domain_name, name) for name in problem_names]
+    domain_pddl = get_domain_pddl(domain_name)
+    problems = parse_problems(domain_pddl, problem_pddls, n_threads=2)
+    for problem, problem_pddl in zip(problems, problem_pddls):
+        assert repr(problem) == repr(parse_problem(domain_pddl, problem_pddl))
@@ -0,0 +1,108 @@
+import logging
+import pickle
+from concurrent.futures import ProcessPoolExecutor
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset
+from neurips24 import get_random_walk
+from util import init_ilg_features
+
+from wlplan.data import DomainDataset, ProblemDataset
+from wlplan.feature_generator import init_feature_generator
+
+
+LOGGER = logging.getLogger(__name__)
+
+FEATURES = ["wl", "kwl2", "lwl2", "iwl"]
+
+
+def train(domain_name, feature_algorithm, pruning="none"):
+    domain, dataset, y = get_dataset(domain_name, keep_statics=False)
+    feature_generator = init_ilg_features(domain, feature_algorithm, pruning=pruning)
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+    weights = np.linalg.lstsq(X, np.array(y, dtype=float), rcond=None)[0]
+    feature_generator.set_weights(weights.tolist())
+    return feature_generator, dataset, X
+
+
+def predict_all(feature_generator, dataset):
+    ret = []
+    for data in dataset.data:
+        feature_generator.set_problem(data.problem)
+        ret.extend(feature_generator.predict(state) for state in data.states)
+    return ret
+
+
+@pytest.mark.parametrize("feature_algorithm", FEATURES)
+def test_pickle(feature_algorithm):
+    feature_generator, dataset, X = train("blocksworld", feature_algorithm)
+    buffers = []
+    data = pickle.dumps(feature_generator, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1, "binary form should be pickled out of band"
+    in_band = pickle.loads(pickle.dumps(feature_generator))
+    for loaded in [pickle.loads(data, buffers=buffers), in_band]:
+        assert type(loaded) is type(feature_generator)
+        assert loaded.get_n_features() == feature_generator.get_n_features()
+        assert loaded.get_weights() == feature_generator.get_weights()
+        loaded_X = np.array(loaded.embed(dataset)).astype(float)
+        assert (loaded_X == X).all()
+        assert predict_all(loaded, dataset) == predict_all(feature_generator, dataset)
+
+
+def test_pickle_pruned():
+    feature_generator, dataset, X = train("ferry", "wl", pruning="i-g")
+    loaded = pickle.loads(pickle.dumps(feature_generator, protocol=5))
+    assert loaded.get_pruning() == feature_generator.get_pruning()
+    assert loaded.get_layer_to_n_colours() == feature_generator.get_layer_to_n_colours()
+    assert (np.array(loaded.embed(dataset)).astype(float) == X).all()
+
+
+def test_pickle_partition():
+    domain, dataset, _ = get_dataset("blocksworld", keep_statics=False)
+    feature_generator = init_ilg_features(domain)
+    feature_generator.set_refinement("partition")
+    feature_generator.collect(dataset)
+    loaded = pickle.loads(pickle.dumps(feature_generator, protocol=5))
+    assert loaded.get_refinement() == "partition"
+    assert loaded.embed(dataset) == feature_generator.embed(dataset)
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld", "rovers"])
+def test_pickle_numeric(domain_name):
+    domain, problem, states = get_random_walk(domain_name)
+    dataset = DomainDataset(domain=domain, data=[ProblemDataset(problem=problem, states=states)])
+    feature_generator = init_feature_generator(
+        feature_algorithm="ccwl-a", domain=domain, graph_representation="nilg", iterations=2
+    )
+    feature_generator.collect(dataset)
+    n_colours = feature_generator.get_n_colours()
+    pairs = [(i, (i + 1) % n_colours) for i in range(n_colours)]
+    feature_generator.set_selected_pairs([(i, j) for i, j in pairs if i != j])
+    n_features = feature_generator.get_n_features()
+    feature_generator.set_sparse_weights([(i, float(i + 1)) for i in range(0, n_features, 3)])
+    X = np.array(feature_generator.embed(dataset)).astype(float)
+
+    buffers = []
+    data = pickle.dumps(feature_generator, protocol=5, buffer_callback=buffers.append)
+    in_band = pickle.loads(pickle.dumps(feature_generator))
+    for loaded in [pickle.loads(data, buffers=buffers), in_band]:
+        assert type(loaded) is type(feature_generator)
+        assert loaded.get_selected_pairs() == feature_generator.get_selected_pairs()
+        assert loaded.get_sparse_weights() == feature_generator.get_sparse_weights()
+        assert loaded.get_n_features() == n_features
+        assert (np.array(loaded.embed(dataset)).astype(float) == X).all()
+        assert predict_all(loaded, dataset) == predict_all(feature_generator, dataset)
+
+
+def test_process_pool():
+    feature_generator, dataset, _ = train("blocksworld", "wl")
+    expected = predict_all(feature_generator, dataset)
+    with ProcessPoolExecutor(max_workers=2) as executor:
+        futures = [
+            executor.submit(predict_all, feature_generator, dataset),
+            executor.submit(predict_all, feature_generator, dataset),
+        ]
+        for future in futures:
+            assert future.result() == expected
@@ -1,10 +1,12 @@
 import logging
+import sys
 from itertools import product
 
 import pytest
 from colours import DOMAINS, colours_test
+from ipc23lt import get_dataset
 
-from wlplan.feature_generator import PruningOptions
+from wlplan.feature_generator import PruningOptions, init_feature_generator
 
 
 LOGGER = logging.getLogger(__name__)
@@ -21,3 +23,57 @@ def test_domain(domain_name, pruning):
 # @pytest.mark.parametrize("domain_name,pruning", product(DOMAINS, ["i-mf"]))
 # def test_expressive(domain_name, pruning):
 #     colours_test(domain_name, 2, "lwl2", pruning)
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld", "childsnack"])
+def test_frequency_pruning(domain_name):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+
+    def _n_features(threshold, sketch_width):
+        feature_generator = init_feature_generator(
+            feature_algorithm="wl",
+            domain=domain,
+            graph_representation="ilg",
+            iterations=3,
+            pruning="i-f",
+            multiset_hash=True,
+        )
+        feature_generator.set_frequency_pruning(threshold=threshold, sketch_width=sketch_width)
+        feature_generator.collect(dataset)
+        return feature_generator.get_n_features()
+
+    exact = _n_features(0.01, 0)
+    LOGGER.info(f"{exact=}")
+
+    # a sketch much wider than the number of colours is exact, and a narrow sketch only overestimates
+    assert _n_features(0.01, 2**20) == exact
+    assert _n_features(0.01, 16) >= exact
+    assert _n_features(0.1, 0) <= exact
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld"])
+def test_greedy_maxsat(domain_name, monkeypatch):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+
+    def _init():
+        return init_feature_generator(
+            feature_algorithm="wl",
+            domain=domain,
+            graph_representation="ilg",
+            iterations=2,
+            pruning="i-m",
+            multiset_hash=True,
+        )
+
+    exact = _init()
+    exact.collect(dataset)
+
+    # without pysat, MaxSAT pruning only gives an approximate solution when asked to
+    for module in ["pysat", "pysat.examples.rc2", "pysat.formula"]:
+        monkeypatch.setitem(sys.modules, module, None)
+    with pytest.raises(ImportError):
+        _init().collect(dataset)
+    greedy = _init()
+    greedy.set_greedy_maxsat(True)
+    greedy.collect(dataset)
+    assert greedy.get_n_features() >= exact.get_n_features()
@@ -1,14 +1,21 @@
 import logging
 import pickle
+import pickletools
 from typing import Any
 
 import pytest
-from ipc23lt import DOMAINS as IPC23LT_DOMAINS, get_domain_problem as get_ipc23lt_domain_problem
+from ipc23lt import (
+    DOMAINS as IPC23LT_DOMAINS,
+    get_dataset,
+    get_domain_problem as get_ipc23lt_domain_problem,
+)
 from neurips24 import (
     DOMAINS as NEURIPS24_DOMAINS,
     get_domain_problem as get_neurips24_domain_problem,
 )
 
+from wlplan.planning import Domain, Predicate, Problem, State
+
 
 def save_then_load(input: Any):
     pkl_file = "tmp.pkl"
@@ -40,3 +47,72 @@ def test_numeric(domain_name):
 
     save_then_load(domain)
     save_then_load(problem)
+
+
+def out_of_band(input: Any):
+    buffers = []
+    data = pickle.dumps(input, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == 1, "binary form should be pickled out of band"
+    return pickle.loads(data, buffers=buffers)
+
+
+@pytest.mark.parametrize("domain_name", ["blocksworld", "childsnack"])
+def test_dataset_buffers(domain_name):
+    _, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    for output in [out_of_band(dataset), pickle.loads(pickle.dumps(dataset, protocol=4))]:
+        assert output.domain == dataset.domain
+        assert len(output.data) == len(dataset.data)
+        for data, output_data in zip(dataset.data, output.data):
+            assert output_data.problem == data.problem
+            assert output_data.states == data.states
+
+    data = dataset.data[0]
+    output = out_of_band(data)
+    assert output.problem == data.problem
+    assert output.states == data.states
+    state = data.states[0]
+    assert out_of_band(state) == state
+    assert hash(out_of_band(state)) == hash(state)
+
+
+@pytest.mark.parametrize("domain_name", sorted(NEURIPS24_DOMAINS))
+def test_numeric_buffers(domain_name):
+    _, problem = get_neurips24_domain_problem(domain_name, problem_name="0_01")
+    output = out_of_band(problem)
+    assert output == problem
+    for goal, output_goal in zip(problem.numeric_goals, output.numeric_goals):
+        values = problem.init_fluent_values
+        assert output_goal.evaluate_error(values) == goal.evaluate_error(values)
+
+
+def test_states_share_symbol_table():
+    _, dataset, _ = get_dataset("blocksworld", keep_statics=False)
+    states = out_of_band(dataset.data[0]).states
+    assert all(state.is_packed for state in states)
+    buffers = []
+    data = pickle.dumps(states, protocol=5, buffer_callback=buffers.append)
+    assert len(buffers) == len(states)
+
+    # the table of the problem is pickled in band once for all states
+    n_tables = sum("BINBYTES" in op.name for op, _, _ in pickletools.genops(data))
+    assert n_tables == 1
+    output = pickle.loads(data, buffers=buffers)
+    assert output == states
+    assert all(state.is_packed for state in output)
+
+
+def test_unsorted_predicate_colours():
+    predicates = [Predicate("on", 2), Predicate("clear", 1), Predicate("arm-empty", 0)]
+    domain = Domain("blocksworld", predicates)
+    problem = Problem(domain, ["a", "b"], [], [])
+    tuple_output = Problem(pickle.loads(pickle.dumps(domain)), ["a", "b"], [], [])
+    for output in [out_of_band(problem), tuple_output]:
+        assert output.predicate_to_id == problem.predicate_to_id
+
+
+def test_legacy_state():
+    _, dataset, _ = get_dataset("blocksworld", keep_statics=False)
+    state = dataset.data[0].states[0]
+    output = State.__new__(State)
+    output.__setstate__((state.atoms, state.values))
+    assert output == state
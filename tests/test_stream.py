@@ -0,0 +1,33 @@
+import logging
+
+import numpy as np
+import pytest
+from ipc23lt import get_dataset, get_raw_dataset
+from util import init_ilg_features
+
+from wlplan.feature_generator import collect_stream, embed_stream
+
+
+LOGGER = logging.getLogger(__name__)
+
+DOMAINS = ["blocksworld", "childsnack", "ferry"]
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+@pytest.mark.parametrize("feature_algorithm", ["wl", "lwl2", "ccwl"])
+def test_stream(domain_name: str, feature_algorithm: str):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    _, data, _ = get_raw_dataset(domain_name, keep_statics=False)
+
+    feature_generator = init_ilg_features(domain, feature_algorithm)
+    feature_generator.collect(dataset)
+    X = np.array(feature_generator.embed(dataset))
+
+    # chunks are produced lazily
+    stream_generator = init_ilg_features(domain, feature_algorithm)
+    collect_stream(stream_generator, ((problem, states) for problem, states in data))
+    assert stream_generator.get_n_features() == feature_generator.get_n_features()
+    assert stream_generator.get_iterations() == feature_generator.get_iterations()
+
+    X_stream = np.concatenate([np.array(x) for x in embed_stream(stream_generator, iter(data))])
+    assert (X_stream == X).all()
@@ -1,7 +1,12 @@
 import logging
 
+import numpy as np
 import pytest
 from colours import DOMAINS, colours_test
+from ipc23lt import get_dataset
+from util import init_ilg_features
+
+from wlplan.feature_generator import load_feature_generator
 
 
 LOGGER = logging.getLogger(__name__)
@@ -11,3 +16,59 @@ LOGGER = logging.getLogger(__name__)
 @pytest.mark.parametrize("wl_algorithm", ["wl", "iwl", "niwl", "lwl2"])
 def test_domain(domain_name: str, wl_algorithm: str):
     colours_test(domain_name=domain_name, iterations=2, feature_algorithm=wl_algorithm)
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+@pytest.mark.parametrize("multiset_hash", [False, True])
+def test_partition_refinement(domain_name: str, multiset_hash: bool):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    feature_generator = init_ilg_features(domain, iterations=4, multiset_hash=multiset_hash)
+    feature_generator.collect(dataset)
+    X_node = np.array(feature_generator.embed(dataset))
+    feature_generator.set_refinement("partition")
+    X_partition = np.array(feature_generator.embed(dataset))
+    assert (X_node == X_partition).all()
+
+
+def test_refinement_save_load(tmp_path):
+    domain, dataset, _ = get_dataset("blocksworld", keep_statics=False)
+    feature_generator = init_ilg_features(domain)
+    feature_generator.set_refinement("partition")
+    feature_generator.collect(dataset)
+    save_file = str(tmp_path / "wl.json")
+    feature_generator.save(save_file)
+    loaded = load_feature_generator(save_file, quiet=True)
+    assert loaded.get_refinement() == "partition"
+    assert loaded.embed(dataset) == feature_generator.embed(dataset)
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+def test_signature_hash(domain_name: str):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    X = {}
+    for signature_hash in [False, True]:
+        feature_generator = init_ilg_features(domain, iterations=4)
+        feature_generator.set_signature_hash(signature_hash)
+        feature_generator.collect(dataset)
+        X[signature_hash] = np.array(feature_generator.embed(dataset))
+
+    # without collisions, colours are created in the same order
+    assert (X[False] == X[True]).all()
+
+
+@pytest.mark.parametrize("domain_name", DOMAINS)
+@pytest.mark.parametrize("feature_algorithm", ["wl", "ccwl", "lwl2"])
+def test_hashed_features(domain_name: str, feature_algorithm: str):
+    domain, dataset, _ = get_dataset(domain_name, keep_statics=False)
+    hash_dim = 1024
+    feature_generator = init_ilg_features(domain, feature_algorithm)
+    feature_generator.set_hash_dim(hash_dim)
+
+    # no collection is needed and the output dimension is fixed
+    X = np.array(feature_generator.embed(dataset))
+    n_features = 2 * hash_dim if feature_algorithm == "ccwl" else hash_dim
+    assert X.shape[1] == n_features
+    assert feature_generator.get_n_features() == n_features
+
+    feature_generator.collect(dataset)
+    assert (np.array(feature_generator.embed(dataset)) == X).all()
@@ -1,5 +1,7 @@
 import logging
 
+from wlplan.feature_generator import init_feature_generator
+
 
 LOGGER = logging.getLogger(__name__)
 
@@ -19,3 +21,21 @@ def print_mat(mat: list[list], rjust: bool = True):
             else:
                 ret += str(cell).ljust(max_lengths[i]) + "  "
         LOGGER.info(ret)
+
+
+def init_ilg_features(
+    domain,
+    feature_algorithm: str = "wl",
+    iterations: int = 2,
+    multiset_hash: bool = True,
+    pruning: str = "none",
+):
+    """Feature generator on instance learning graphs, as used by most tests."""
+    return init_feature_generator(
+        feature_algorithm=feature_algorithm,
+        domain=domain,
+        graph_representation="ilg",
+        iterations=iterations,
+        pruning=pruning,
+        multiset_hash=multiset_hash,
+    )
@@ -1,5 +1,6 @@
 import json
 import os
+from typing import Iterable, Iterator, Optional
 
 from _wlplan.feature_generator import (
     CCWLaFeatures,
@@ -12,15 +13,19 @@ from _wlplan.feature_generator import (
     PruningOptions,
     WLFeatures,
 )
-from _wlplan.planning import Domain
+from _wlplan.planning import Domain, Problem, State
 from wlplan.graph_generator import get_available_graph_generators
 
 
 __all__ = [
     "init_feature_generator",
+    "collect_stream",
+    "embed_stream",
     "get_available_feature_generators",
     "get_available_graph_generators",
     "get_available_pruning_methods",
+    "load_feature_generator",
+    "merge_feature_generators",
     "Features",
 ]
 
@@ -69,7 +74,10 @@ def init_feature_generator(
             The number of WL iterations to perform.
 
         pruning : str, default="none"
-            How to detect and prune duplicate features. If `"none"`, no pruning is done.
+            How to detect and prune duplicate features. If `"none"`, no pruning is done. The
+            MaxSAT options `"a-m"`, `"i-m"` and `"i-mf"` require pysat. Builds without Python
+            solve them with an approximate greedy solver that may keep more features, which
+            Python builds only use after `set_greedy_maxsat(True)`.
 
         multiset_hash : bool, default=False
             Choose to use either set or multiset to store neighbour colours.
@@ -137,3 +145,88 @@ def load_feature_generator(filename: str, quiet: bool = False) -> Features:
         raise ValueError(f"Unknown {feature_generator=} in {filename=}")
 
     return _FEATURE_ALGORITHMS[feature_generator](filename=filename, quiet=quiet)
+
+
+def merge_feature_generators(
+    filenames: list[str], save_file: Optional[str] = None, quiet: bool = True
+) -> tuple[Features, list[dict[int, int]]]:
+    """
+    Merge feature generators with the same configuration that were collected and saved
+    independently, e.g. on disjoint shards of a dataset.
+
+    Parameters
+    ----------
+        filenames : list[str]
+            Saved feature generators to merge.
+
+        save_file : str, optional
+            If given, save the merged feature generator to this file.
+
+        quiet : bool, default=True
+            If True, suppress model information logging when loading.
+
+    Returns
+    -------
+        Features: The merged feature generator.
+
+        list[dict[int, int]]: For each input file, the map from its colour ids to merged colour ids,
+        which can be used to translate embeddings computed with the input generators.
+    """
+    if len(filenames) == 0:
+        raise ValueError("No feature generators to merge")
+
+    feature_generator = load_feature_generator(filenames[0], quiet=quiet)
+    remaps = [{col: col for col in range(feature_generator.get_n_colours())}]
+    for filename in filenames[1:]:
+        other = load_feature_generator(filename, quiet=quiet)
+        remap, other_remap = feature_generator.merge(other)
+        remaps = [{old: remap[new] for old, new in r.items()} for r in remaps]
+        remaps.append(other_remap)
+
+    if save_file is not None:
+        feature_generator.save(save_file)
+
+    return feature_generator, remaps
+
+
+def collect_stream(
+    feature_generator: Features, chunks: Iterable[tuple[Problem, list[State]]]
+) -> None:
+    """
+    Collect colours over an iterable of (problem, states) chunks. Only one chunk is converted to
+    graphs at a time, so the full dataset never needs to be in memory. Not supported with pruning.
+
+    Parameters
+    ----------
+        feature_generator : Features
+            The feature generator to collect colours for.
+
+        chunks : Iterable[tuple[Problem, list[State]]]
+            Training states grouped by problem, e.g. produced lazily by a generator.
+    """
+    for problem, states in chunks:
+        feature_generator.collect_problem(problem, states)
+    feature_generator.end_collect()
+
+
+def embed_stream(
+    feature_generator: Features, chunks: Iterable[tuple[Problem, list[State]]]
+) -> Iterator[list[list[float]]]:
+    """
+    Embed an iterable of (problem, states) chunks, yielding the embeddings of each chunk as soon as
+    it is computed so that they can be written out chunk by chunk.
+
+    Parameters
+    ----------
+        feature_generator : Features
+            The collected feature generator.
+
+        chunks : Iterable[tuple[Problem, list[State]]]
+            States grouped by problem, e.g. produced lazily by a generator.
+
+    Yields
+    ------
+        list[list[float]]: The embeddings of the states of a chunk.
+    """
+    for problem, states in chunks:
+        yield feature_generator.embed_problem(problem, states)
@@ -23,10 +23,14 @@ from _wlplan.planning import (
     Problem,
     Schema,
     State,
+    parse_domain as _parse_domain,
+    parse_problem as _parse_problem,
+    parse_problems as _parse_problems,
+    states_from_arrays,
 )
 
 
-__all__ = ["parse_domain", "parse_problem"]
+__all__ = ["parse_domain", "parse_problem", "parse_problems"]
 
 _PDDL_TO_WLPLAN_BINARY_OPS = {
     pddl.logic.functions.Plus: OperatorType.Plus,
@@ -263,12 +267,7 @@ def parse_domain(
     if not os.path.exists(domain_path):
         raise FileNotFoundError(f"Domain file {domain_path} does not exist.")
 
-    # Parse domain with the pddl package
-    pddl_domain = pddl.parse_domain(domain_path)
-
-    return to_wlplan_domain(
-        pddl_domain=pddl_domain, domain_name=domain_name, keep_statics=keep_statics
-    )
+    return _parse_domain(domain_path, domain_name or "", keep_statics)
 
 
 def parse_problem(domain_path: str, problem_path: str, keep_statics: bool = True) -> Problem:
@@ -280,16 +279,30 @@ def parse_problem(domain_path: str, problem_path: str, keep_statics: bool = True
         keep_statics (bool, optional): Whether to keep static predicates in the parsed domain. Defaults to True.
     """
 
-    if not os.path.exists(problem_path):
-        raise FileNotFoundError(f"Problem file {problem_path} does not exist.")
+    for path in [domain_path, problem_path]:
+        if not os.path.exists(path):
+            raise FileNotFoundError(f"PDDL file {path} does not exist.")
 
-    # Use the pddl package to help with parsing
-    pddl_domain = pddl.parse_domain(domain_path)
-    pddl_problem = pddl.parse_problem(problem_path)
+    return _parse_problem(domain_path, problem_path, keep_statics)
 
-    return to_wlplan_problem(
-        pddl_domain=pddl_domain, pddl_problem=pddl_problem, keep_statics=keep_statics
-    )
+
+def parse_problems(
+    domain_path: str, problem_paths: list[str], keep_statics: bool = True, n_threads: int = 0
+) -> list[Problem]:
+    """Parses problem files of the same domain in parallel and returns a list of Problem objects.
+
+    Args:
+        domain_path (str): The path to the domain file, which is parsed once.
+        problem_paths (list[str]): The paths to the problem files.
+        keep_statics (bool, optional): Whether to keep static predicates in the parsed domain. Defaults to True.
+        n_threads (int, optional): The number of threads, or one per core if not positive. Defaults to 0.
+    """
+
+    for path in [domain_path] + list(problem_paths):
+        if not os.path.exists(path):
+            raise FileNotFoundError(f"PDDL file {path} does not exist.")
+
+    return _parse_problems(domain_path, list(problem_paths), keep_statics, n_threads)
 
 
 if __name__ == "__main__":